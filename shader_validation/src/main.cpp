@@ -20,6 +20,7 @@ struct vec4T {
     T z;
     T w;
 
+    vec4T() : vec4T(0) {}
     explicit vec4T(T val) : x(val), y(val), z(val), w(val) {}
     vec4T(T x, T y, T z, T w) : x(x), y(y), z(z), w(w) {}
 
@@ -33,6 +34,7 @@ struct vec2T {
     T x;
     T y;
 
+    vec2T() : vec2T(0) {}
     explicit vec2T(T val) : x(val), y(val) {}
     vec2T(T x, T y) : x(x), y(y) {}
 
@@ -112,6 +114,11 @@ T atomicExchange(std::atomic<T>& data, T val) {
     return data.exchange(val);
 }
 
+template <class T>
+T atomicOr(std::atomic<T>& data, T val) {
+    return data.fetch_or(val);
+}
+
 float distance(const vec2& v1, const vec2& v2) {
     return static_cast<float>(std::sqrt(std::pow(v2.x - v1.x, 2) + std::pow(v2.y - v1.y, 2)));
 }
@@ -124,15 +131,10 @@ vec2 clamp(const vec2& v, const vec2& minVec, const vec2& maxVec) {
     return {std::max(minVec.x, std::min(maxVec.x, v.x)), std::max(minVec.y, std::min(maxVec.y, v.y))};
 }
 
-struct EntityDescriptor {
-    vec4 color{0};  // Offset: 0-15
-    uvec4 randState{0};  // Offset 16-31
-    vec2 pos{0};  // Offset: 32-39
-    vec2 target{0};  // Offset: 40-47
-    vec2 direction{0};  // Offset: 48-55
-    uint roadIndex{0};  // Offset: 56-59
-    uint initialized{0};  // Offset: 60-63
-} __attribute__((packed)) __attribute__((aligned(64)));  // Size will be rounded up to the next multiple of the largest member (vec4) -> 64 Bytes
+struct EntityMotionDescriptor {
+    vec2 target{0};  // Offset: 0-7
+    vec2 direction{0};  // Offset: 8-15
+} __attribute__((packed)) __attribute__((aligned(16)));  // 16 Bytes
 
 struct PushConstantsDescriptor {
     float worldSizeX{0};
@@ -151,7 +153,15 @@ const size_t NUM_NODES = 21845;
 const size_t NUM_ENTITIES = 1000;  // 246400;
 const float COLLISION_RADIUS = 10;
 
-static std::array<EntityDescriptor, NUM_ENTITIES> entities{};
+// Entities are stored as structure of arrays, matching the buffers bound to random_move.comp:
+static std::array<vec2, NUM_ENTITIES> entityPositions{};
+static std::array<EntityMotionDescriptor, NUM_ENTITIES> entityMotions{};
+// One bit per entity that gets set in case the entity collided during the last collision pass:
+static std::array<std::atomic<uint>, (NUM_ENTITIES + 31) / 32> entityCollisionBits{};
+static std::array<uint, NUM_ENTITIES> entityStates{};
+
+// Bits of entityStates:
+const uint ENTITY_STATE_INITIALIZED = 1;
 static PushConstantsDescriptor pushConsts{29007.4609, 16463.7656, NUM_NODES, MAX_DEPTH, COLLISION_RADIUS};
 
 // ------------------------------------------------------------------------------------
@@ -434,7 +444,7 @@ void quad_tree_move_entities(uint nodeIndex) {
         quadTreeEntities[index].next = 0;
         quadTreeEntities[index].typeNext = TYPE_INVALID;
 
-        vec2 ePos = entities[index].pos;
+        vec2 ePos = entityPositions[index];
 
         uint newNodeIndex = 0;
         // Left:
@@ -484,7 +494,7 @@ void quad_tree_split_up_node(uint nodeIndex) {
 bool quad_tree_same_pos_as_fist(uint nodeIndex, vec2 ePos) {
     if (quadTreeNodes[nodeIndex].entityCount > 0) {
         uint index = quadTreeNodes[nodeIndex].first;
-        return entities[index].pos == ePos;
+        return entityPositions[index] == ePos;
     }
     return false;
 }
@@ -493,7 +503,7 @@ void quad_tree_insert(uint index, uint startNodeIndex, uint startNodeDepth) {
     // Count the number of inserted items:
     atomicAdd(debugData[0], static_cast<uint>(1));
 
-    vec2 ePos = entities[index].pos;
+    vec2 ePos = entityPositions[index];
     uint curDepth = startNodeDepth;
 
     uint nodeIndex = startNodeIndex;
@@ -561,7 +571,7 @@ bool quad_tree_is_entity_on_node(uint nodeIndex, vec2 ePos) {
  * Moves down the quad tree and locks all nodes as read, except the last node, which gets locked as write so we can edit it.
  **/
 uint quad_tree_lock_for_entity_edit(uint index) {
-    vec2 ePos = entities[index].pos;
+    vec2 ePos = entityPositions[index];
     uint nodeIndex = 0;
     while (true) {
         quad_tree_lock_node_read(nodeIndex);
@@ -688,7 +698,7 @@ void quad_tree_update(uint index, vec2 newPos) {
 
     // Still on the same node, so we do not need to do anything:
     if (quad_tree_is_entity_on_node(quadTreeEntities[index].nodeIndex, newPos)) {
-        entities[index].pos = newPos;
+        entityPositions[index] = newPos;
         quad_tree_unlock_node_read(quadTreeEntities[index].nodeIndex);
         return;
     }
@@ -719,10 +729,10 @@ void quad_tree_update(uint index, vec2 newPos) {
     quad_tree_unlock_node_write(nodeIndex);
 
     // Update the removed entity position:
-    entities[index].pos = newPos;
+    entityPositions[index] = newPos;
 
     // Move up until we reach a node where our entity is on:
-    while (!quad_tree_is_entity_on_node(nodeIndex, entities[index].pos)) {
+    while (!quad_tree_is_entity_on_node(nodeIndex, entityPositions[index])) {
         uint oldNodeIndex = nodeIndex;
         nodeIndex = quadTreeNodes[nodeIndex].prevNodeIndex;
         quad_tree_unlock_node_read(oldNodeIndex);
@@ -739,8 +749,8 @@ void quad_tree_update(uint index, vec2 newPos) {
  * Called only once per collision pair.
  **/
 void quad_tree_collision(uint index0, uint index1) {
-    entities[index0].color = vec4(1, 0, 0, 1);
-    entities[index1].color = vec4(1, 0, 0, 1);
+    atomicOr(entityCollisionBits[index0 / 32], static_cast<uint>(1) << (index0 % 32));
+    atomicOr(entityCollisionBits[index1 / 32], static_cast<uint>(1) << (index1 % 32));
     atomicAdd(debugData[1], static_cast<uint>(1));
 }
 
@@ -765,13 +775,13 @@ void quad_tree_check_entity_collisions_on_node(uint index, uint nodeIndex) {
         return;
     }
 
-    vec2 ePos = entities[index].pos;
+    vec2 ePos = entityPositions[index];
 
     uint curEntityIndex = quadTreeNodes[nodeIndex].first;
     while (true) {
         // atomicAdd(debugData[7], static_cast<uint>(1));
         // Prevent checking collision with our self and prevent duplicate entries by checking only for ones where the ID is smaller than ours:
-        if (curEntityIndex < index && quad_tree_in_range(entities[curEntityIndex].pos, ePos, pushConsts.collisionRadius)) {
+        if (curEntityIndex < index && quad_tree_in_range(entityPositions[curEntityIndex], ePos, pushConsts.collisionRadius)) {
             quad_tree_collision(index, curEntityIndex);
         }
 
@@ -807,7 +817,7 @@ bool quad_tree_collision_on_node(uint index, uint nodeIndex) {
     float nodeOffsetX = quadTreeNodes[nodeIndex].offsetX;
     float nodeOffsetY = quadTreeNodes[nodeIndex].offsetY;
 
-    vec2 ePos = entities[index].pos;
+    vec2 ePos = entityPositions[index];
     vec2 aabbHalfExtents = vec2((quadTreeNodes[nodeIndex].width / 2), (quadTreeNodes[nodeIndex].height / 2));
     vec2 nodeCenter = vec2(nodeOffsetX, nodeOffsetY) + aabbHalfExtents;
     vec2 diff = ePos - nodeCenter;
@@ -869,7 +879,7 @@ bool quad_tree_collisions_only_on_same_node(uint index, uint nodeIndex) {
     float nodeOffsetX = quadTreeNodes[nodeIndex].offsetX;
     float nodeOffsetY = quadTreeNodes[nodeIndex].offsetY;
 
-    vec2 ePos = entities[index].pos;
+    vec2 ePos = entityPositions[index];
     vec2 minEPos = ePos - vec2(pushConsts.collisionRadius);
     minEPos = vec2(std::max(minEPos.x, 0.0F), std::max(minEPos.y, 0.0F));
     vec2 maxEPos = ePos + vec2(pushConsts.collisionRadius);
@@ -933,52 +943,55 @@ vec2 random_Target() {
 const float SPEED = 1.4;
 
 void update_direction(uint index, vec2 pos) {
-    vec2 dist = entities[index].target - pos;
+    vec2 dist = entityMotions[index].target - pos;
     float len = length(dist);
     if (len == 0) {
-        entities[index].direction = vec2(0);
+        entityMotions[index].direction = vec2(0);
         return;
     }
     vec2 normVec = dist / vec2(len);
-    entities[index].direction = normVec * vec2(SPEED);
+    entityMotions[index].direction = normVec * vec2(SPEED);
 }
 
 vec2 move(uint index) {
-    float dist = distance(entities[index].pos, entities[index].target);
+    float dist = distance(entityPositions[index], entityMotions[index].target);
 
     if (dist > SPEED) {
-        return entities[index].pos + entities[index].direction;
+        return entityPositions[index] + entityMotions[index].direction;
     }
 
-    vec2 newPos = entities[index].target;
-    entities[index].target = random_Target();
+    vec2 newPos = entityMotions[index].target;
+    entityMotions[index].target = random_Target();
     update_direction(index, newPos);
     return newPos;
 }
 
 void shader_main(uint index) {
-    if (entities[index].initialized == 0) {
-        entities[index].pos = random_Target();
+    if ((entityStates[index] & ENTITY_STATE_INITIALIZED) == 0) {
+        entityPositions[index] = random_Target();
         quad_tree_insert(index, 0, 1);
-        entities[index].initialized = 1;
+        entityStates[index] |= ENTITY_STATE_INITIALIZED;
         return;
     }
 
     if ((pushConsts.tick % 2) == 0) {
-        update_direction(index, entities[index].pos);
+        // Clear the collision state for the upcoming collision pass. Each of the first invocations clears 32 entities at once:
+        if (index < entityCollisionBits.size()) {
+            entityCollisionBits[index] = 0;
+        }
+        update_direction(index, entityPositions[index]);
         vec2 newPos = move(index);
         // vec2 newPos = random_Target();
         quad_tree_update(index, newPos);
     } else {
-        entities[index].color = vec4(0, 1, 0, 1);
         quad_tree_check_collisions(index);
     }
 }
 
 void shader_main_move_only(uint index) {
-    if (entities[index].initialized == 0) {
+    if ((entityStates[index] & ENTITY_STATE_INITIALIZED) == 0) {
         quad_tree_insert(index, 0, 1);
-        entities[index].initialized = 1;
+        entityStates[index] |= ENTITY_STATE_INITIALIZED;
         return;
     }
 
@@ -1003,13 +1016,17 @@ void reset() {
         i = 0;
     }
 
+    for (std::atomic<uint>& i : entityCollisionBits) {
+        i = 0;
+    }
+
     pushConsts.tick = 0;
 }
 
 void init() {
     // Entities:
-    for (size_t index = 0; index < entities.size(); index++) {
-        entities[index].pos = move(index);
+    for (size_t index = 0; index < entityPositions.size(); index++) {
+        entityPositions[index] = move(index);
     }
 
     // Quad Tree:
@@ -1075,8 +1092,8 @@ void run_default() {
     std::barrier syncPoint(THREAD_COUNT);
     std::barrier incSyncPoint(THREAD_COUNT);
     for (size_t i = 0; i < THREAD_COUNT; i++) {
-        size_t start = (entities.size() / THREAD_COUNT) * i;
-        size_t end = (entities.size() / THREAD_COUNT) * (i + 1);
+        size_t start = (entityPositions.size() / THREAD_COUNT) * i;
+        size_t end = (entityPositions.size() / THREAD_COUNT) * (i + 1);
         threads.emplace_back([start, end, i, &syncPoint, &incSyncPoint]() {
             std::chrono::high_resolution_clock::time_point lastStartTp = std::chrono::high_resolution_clock::now();
             std::chrono::high_resolution_clock::time_point lastStartMoveTp = std::chrono::high_resolution_clock::now();
@@ -1139,14 +1156,14 @@ void run_collision_detection_test_1() {
     reset();
     init();
 
-    entities[0].pos = vec2((pushConsts.worldSizeX / 2) - 3, 0);
+    entityPositions[0] = vec2((pushConsts.worldSizeX / 2) - 3, 0);
     quad_tree_insert(0, 0, 1);
     validate_entity_count(1);
     quad_tree_check_collisions(0);
     assert(debugData[1] == 0);
     debugData[1] = 0;
 
-    entities[1].pos = vec2((pushConsts.worldSizeX / 2) + 3, 0);
+    entityPositions[1] = vec2((pushConsts.worldSizeX / 2) + 3, 0);
     quad_tree_insert(1, 0, 1);
     validate_entity_count(2);
     quad_tree_check_collisions(0);
@@ -1155,7 +1172,7 @@ void run_collision_detection_test_1() {
     assert(debugData[1] == 1);
     debugData[1] = 0;
 
-    entities[2].pos = vec2(0, 0);
+    entityPositions[2] = vec2(0, 0);
     quad_tree_insert(2, 0, 1);
     validate_entity_count(3);
     quad_tree_check_collisions(0);
@@ -1166,7 +1183,7 @@ void run_collision_detection_test_1() {
     assert(debugData[1] == 1);
     debugData[1] = 0;
 
-    entities[3].pos = vec2((pushConsts.worldSizeX / 4), 0);
+    entityPositions[3] = vec2((pushConsts.worldSizeX / 4), 0);
     quad_tree_insert(3, 0, 1);
     validate_entity_count(4);
     quad_tree_check_collisions(0);
@@ -1179,7 +1196,7 @@ void run_collision_detection_test_1() {
     assert(debugData[1] == 1);
     debugData[1] = 0;
 
-    entities[4].pos = vec2((pushConsts.worldSizeX / 4) - 9, 0);
+    entityPositions[4] = vec2((pushConsts.worldSizeX / 4) - 9, 0);
     quad_tree_insert(4, 0, 1);
     validate_entity_count(5);
     quad_tree_check_collisions(0);
@@ -1,11 +1,17 @@
 #include "logger/Logger.hpp"
 #include "sim/Simulator.hpp"
 #include "ui/UiContext.hpp"
+#include "ui/headless/HeadlessRenderer.hpp"
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <optional>
 #include <thread>
+#include <utility>
 
 bool should_run_headless(int argc, char** argv) {
     for (int i = 1; i < argc; i++) {
@@ -17,17 +23,84 @@ bool should_run_headless(int argc, char** argv) {
     return false;
 }
 
-int run_headless() {
+/**
+ * Returns the value following the given option, e.g. "out" for "--render-dir out", or nullptr in case it is not present.
+ **/
+const char* get_option_value(int argc, char** argv, const char* option) {
+    for (int i = 1; i + 1 < argc; i++) {
+        // NOLINTNEXTLINE (cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        if (std::strcmp(argv[i], option) == 0) {
+            // NOLINTNEXTLINE (cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            return argv[i + 1];
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Frames only get rendered in headless mode in case an output directory is given via "--render-dir <dir>".
+ * Optional: "--render-interval <ticks>", "--render-size <width>x<height>" and "--render-format png|raw".
+ **/
+std::optional<ui::headless::HeadlessRenderSettings> parse_render_settings(int argc, char** argv) {
+    const char* outputDir = get_option_value(argc, argv, "--render-dir");
+    if (!outputDir) {
+        return std::nullopt;
+    }
+
+    ui::headless::HeadlessRenderSettings settings{};
+    settings.outputDir = outputDir;
+    if (const char* interval = get_option_value(argc, argv, "--render-interval")) {
+        settings.interval = static_cast<uint32_t>(std::max(std::atoi(interval), 1));
+    }
+    if (const char* size = get_option_value(argc, argv, "--render-size")) {
+        int width = 0;
+        int height = 0;
+        // NOLINTNEXTLINE (cert-err34-c, cppcoreguidelines-pro-type-vararg)
+        if (std::sscanf(size, "%dx%d", &width, &height) == 2 && width > 0 && height > 0) {
+            settings.width = width;
+            settings.height = height;
+        } else {
+            SPDLOG_WARN("Invalid render size '{}'. Expected '<width>x<height>'.", size);
+        }
+    }
+    if (const char* format = get_option_value(argc, argv, "--render-format")) {
+        if (std::strcmp(format, "raw") == 0) {
+            settings.format = ui::headless::FrameFormat::RAW;
+        } else if (std::strcmp(format, "png") != 0) {
+            SPDLOG_WARN("Unknown render format '{}'. Falling back to 'png'.", format);
+        }
+    }
+    return settings;
+}
+
+int run_headless(int argc, char** argv) {
     SPDLOG_INFO("Launching Version {} {} in headless mode.", MOVEMENT_SIMULATOR_VERSION, MOVEMENT_SIMULATOR_VERSION_NAME);
     std::shared_ptr<sim::Simulator> simulator = sim::Simulator::get_instance();
-    simulator->start_worker();
 
+    // Create the renderer before the simulation starts, so it does not miss the first ticks:
+    std::unique_ptr<ui::headless::HeadlessRenderer> renderer{nullptr};
+    if (std::optional<ui::headless::HeadlessRenderSettings> renderSettings = parse_render_settings(argc, argv)) {
+        renderer = std::make_unique<ui::headless::HeadlessRenderer>(std::move(*renderSettings));
+        if (!renderer->init()) {
+            SPDLOG_ERROR("Failed to initialize the headless renderer.");
+            return EXIT_FAILURE;
+        }
+    }
+
+    simulator->start_worker();
     simulator->continue_simulation();
     while (true) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (!renderer) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        } else if (!renderer->render_next()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
     }
 
     simulator->stop_worker();
+    if (renderer) {
+        renderer->cleanup();
+    }
     return EXIT_SUCCESS;
 }
 
@@ -50,7 +123,7 @@ int main(int argc, char** argv) {
     bool headless = should_run_headless(argc, argv);
 
     if (headless) {
-        return run_headless();
+        return run_headless(argc, argv);
     }
     return run_ui(argc, argv);
 }
\ No newline at end of file
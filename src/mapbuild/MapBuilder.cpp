@@ -0,0 +1,450 @@
+#include "MapBuilder.hpp"
+#include "logger/Logger.hpp"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <limits>
+#include <nlohmann/json.hpp>
+#include <numbers>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace mapbuild {
+namespace {
+/**
+ * Mean earth radius in meters, as used by the 'haversine' Python package.
+ * Along a meridian (and along the equator) the haversine distance reduces to this radius times the angle in radians.
+ **/
+constexpr double EARTH_RADIUS = 6371008.8;
+constexpr double METERS_PER_DEGREE = EARTH_RADIUS * std::numbers::pi / 180.0;
+
+struct GeoSegment {
+    double startLat{0};
+    double startLong{0};
+    double endLat{0};
+    double endLong{0};
+};
+
+struct ByteRange {
+    size_t start{0};
+    size_t end{0};
+};
+
+/**
+ * Bit exact key of a coordinate used for deduplication.
+ **/
+struct CoordinateKey {
+    uint64_t lat{0};
+    uint64_t lon{0};
+
+    bool operator==(const CoordinateKey& other) const = default;
+};
+
+struct CoordinateKeyHash {
+    size_t operator()(const CoordinateKey& key) const {
+        // splitmix64 style mixing:
+        uint64_t h = key.lat ^ (key.lon + 0x9E3779B97F4A7C15ULL + (key.lat << 6) + (key.lat >> 2));
+        h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+        return static_cast<size_t>(h ^ (h >> 31));
+    }
+};
+
+struct SegmentKeyHash {
+    size_t operator()(uint64_t key) const {
+        return CoordinateKeyHash{}(CoordinateKey{key, 0});
+    }
+};
+
+/**
+ * Returns the byte ranges of all elements of the top level "features" array.
+ * Only tracks strings and nesting, so it is a lot cheaper than parsing the whole document.
+ **/
+std::vector<ByteRange> split_features(std::string_view buf) {
+    std::vector<ByteRange> features;
+    size_t depth = 0;
+    bool inString = false;
+    bool inFeatures = false;
+    size_t stringStart = 0;
+    size_t featureStart = 0;
+    std::string_view lastRootString;
+
+    for (size_t i = 0; i < buf.size(); i++) {
+        const char c = buf[i];
+        if (inString) {
+            if (c == '\\') {
+                i++;
+            } else if (c == '"') {
+                inString = false;
+                if (depth == 1) {
+                    lastRootString = buf.substr(stringStart, i - stringStart);
+                }
+            }
+            continue;
+        }
+
+        switch (c) {
+            case '"':
+                inString = true;
+                stringStart = i + 1;
+                break;
+
+            case '[':
+            case '{':
+                if (depth == 1 && c == '[' && lastRootString == "features") {
+                    inFeatures = true;
+                } else if (inFeatures && depth == 2) {
+                    featureStart = i;
+                }
+                depth++;
+                break;
+
+            case ']':
+            case '}':
+                if (depth == 0) {
+                    throw std::runtime_error("Failed to parse GeoJSON. Unbalanced brackets.");
+                }
+                depth--;
+                if (inFeatures && depth == 2) {
+                    features.push_back(ByteRange{featureStart, i + 1});
+                } else if (inFeatures && depth == 1) {
+                    inFeatures = false;
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    if (depth != 0 || inString) {
+        throw std::runtime_error("Failed to parse GeoJSON. Unexpected end of file.");
+    }
+    return features;
+}
+
+void add_line_string(const nlohmann::json& jCoordinates, std::vector<GeoSegment>& segments) {
+    if (!jCoordinates.is_array() || jCoordinates.size() < 2) {
+        SPDLOG_DEBUG("Found road with only one point. Ignoring.");
+        return;
+    }
+
+    for (size_t i = 1; i < jCoordinates.size(); i++) {
+        const nlohmann::json& jStart = jCoordinates[i - 1];
+        const nlohmann::json& jEnd = jCoordinates[i];
+        if (jStart.size() < 2 || jEnd.size() < 2) {
+            throw std::runtime_error("Failed to parse GeoJSON. Position with less than two values.");
+        }
+        segments.push_back(GeoSegment{jStart[0].get<double>(), jStart[1].get<double>(), jEnd[0].get<double>(), jEnd[1].get<double>()});
+    }
+}
+
+/**
+ * Parses the given features and appends all their segments.
+ * Features are small, so parsing each into a DOM on its own keeps memory bounded.
+ **/
+void parse_features(std::string_view buf, const ByteRange* first, const ByteRange* last, std::vector<GeoSegment>& segments) {
+    for (const ByteRange* range = first; range != last; range++) {  // NOLINT (cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        const std::string_view feature = buf.substr(range->start, range->end - range->start);
+        const nlohmann::json jFeature = nlohmann::json::parse(feature.begin(), feature.end());
+        if (!jFeature.contains("geometry") || !jFeature["geometry"].is_object()) {
+            continue;
+        }
+        const nlohmann::json& jGeometry = jFeature["geometry"];
+        if (!jGeometry.contains("type") || !jGeometry.contains("coordinates")) {
+            continue;
+        }
+
+        const std::string& type = jGeometry["type"].get_ref<const std::string&>();
+        if (type == "LineString") {
+            add_line_string(jGeometry["coordinates"], segments);
+        } else if (type == "MultiLineString") {
+            for (const nlohmann::json& jLine : jGeometry["coordinates"]) {
+                add_line_string(jLine, segments);
+            }
+        }
+    }
+}
+
+/**
+ * Union-find with path halving and union by size.
+ **/
+class UnionFind {
+ private:
+    std::vector<uint32_t> parents;
+    std::vector<uint32_t> sizes;
+
+ public:
+    explicit UnionFind(size_t count) : parents(count), sizes(count, 1) {
+        for (size_t i = 0; i < count; i++) {
+            parents[i] = static_cast<uint32_t>(i);
+        }
+    }
+
+    uint32_t find(uint32_t i) {
+        while (parents[i] != i) {
+            parents[i] = parents[parents[i]];
+            i = parents[i];
+        }
+        return i;
+    }
+
+    void unite(uint32_t a, uint32_t b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) {
+            return;
+        }
+        if (sizes[a] < sizes[b]) {
+            std::swap(a, b);
+        }
+        parents[b] = a;
+        sizes[a] += sizes[b];
+    }
+};
+
+/**
+ * dst[i] = (src[i] - min) * METERS_PER_DEGREE
+ * Kept as a plain loop over contiguous arrays so the compiler vectorizes it.
+ **/
+void project(const std::vector<double>& src, double min, std::vector<double>& dst) {
+    dst.resize(src.size());
+    const double* in = src.data();
+    double* out = dst.data();
+    const size_t count = src.size();
+    for (size_t i = 0; i < count; i++) {
+        out[i] = (in[i] - min) * METERS_PER_DEGREE;  // NOLINT (cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+}
+}  // namespace
+
+std::optional<RoadGraph> parse_geojson(const std::filesystem::path& path, size_t threadCount) {
+    SPDLOG_INFO("Loading GeoJSON from '{}'...", path.string());
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        SPDLOG_ERROR("Failed to open GeoJSON from '{}'.", path.string());
+        return std::nullopt;
+    }
+    std::string buf(static_cast<size_t>(std::filesystem::file_size(path)), '\0');
+    file.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+    if (!file) {
+        SPDLOG_ERROR("Failed to read GeoJSON from '{}'.", path.string());
+        return std::nullopt;
+    }
+
+    const std::vector<ByteRange> features = split_features(buf);
+    threadCount = std::clamp(threadCount, static_cast<size_t>(1), std::max(features.size(), static_cast<size_t>(1)));
+    SPDLOG_INFO("Parsing {} features with {} threads...", features.size(), threadCount);
+
+    // Each thread parses a contiguous slice of features, so merging the results in order keeps the output deterministic:
+    std::vector<std::vector<GeoSegment>> threadSegments(threadCount);
+    std::vector<std::thread> threads;
+    std::vector<std::exception_ptr> errors(threadCount);
+    threads.reserve(threadCount);
+    const size_t featuresPerThread = (features.size() + threadCount - 1) / threadCount;
+    for (size_t t = 0; t < threadCount; t++) {
+        const size_t first = std::min(t * featuresPerThread, features.size());
+        const size_t last = std::min(first + featuresPerThread, features.size());
+        threads.emplace_back([&, t, first, last]() {
+            try {
+                parse_features(buf, features.data() + first, features.data() + last, threadSegments[t]);  // NOLINT (cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            } catch (...) {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (const std::exception_ptr& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    buf.clear();
+    buf.shrink_to_fit();
+
+    // Deduplicate coordinates and segments:
+    size_t segmentCount = 0;
+    for (const std::vector<GeoSegment>& segments : threadSegments) {
+        segmentCount += segments.size();
+    }
+    RoadGraph graph;
+    graph.segments.reserve(segmentCount);
+    std::unordered_map<CoordinateKey, uint32_t, CoordinateKeyHash> coordinateIds;
+    coordinateIds.reserve(segmentCount + 1);
+    std::unordered_set<uint64_t, SegmentKeyHash> segmentKeys;
+    segmentKeys.reserve(segmentCount);
+
+    auto coordinateId = [&graph, &coordinateIds](double lat, double lon) {
+        auto [iter, inserted] = coordinateIds.try_emplace(CoordinateKey{std::bit_cast<uint64_t>(lat), std::bit_cast<uint64_t>(lon)}, static_cast<uint32_t>(graph.lats.size()));
+        if (inserted) {
+            graph.lats.push_back(lat);
+            graph.longs.push_back(lon);
+        }
+        return iter->second;
+    };
+
+    size_t zeroLengthCount = 0;
+    size_t duplicateCount = 0;
+    for (std::vector<GeoSegment>& segments : threadSegments) {
+        for (const GeoSegment& segment : segments) {
+            const uint32_t start = coordinateId(segment.startLat, segment.startLong);
+            const uint32_t end = coordinateId(segment.endLat, segment.endLong);
+            if (start == end) {
+                zeroLengthCount++;
+                continue;
+            }
+
+            // Roads can be used in both directions, so A->B and B->A are the same road:
+            const uint64_t key = (static_cast<uint64_t>(std::min(start, end)) << 32) | std::max(start, end);
+            if (!segmentKeys.insert(key).second) {
+                duplicateCount++;
+                continue;
+            }
+            graph.segments.push_back(RoadGraph::Segment{start, end});
+        }
+        segments.clear();
+        segments.shrink_to_fit();
+    }
+
+    SPDLOG_INFO("Found {} road pieces with {} coordinates. Skipped {} zero length and {} duplicate pieces.", graph.segments.size(), graph.lats.size(), zeroLengthCount, duplicateCount);
+    return graph;
+}
+
+void remove_disconnected(RoadGraph& graph) {
+    if (graph.segments.empty()) {
+        return;
+    }
+
+    UnionFind uf(graph.lats.size());
+    for (const RoadGraph::Segment& segment : graph.segments) {
+        uf.unite(segment.start, segment.end);
+    }
+
+    // Find the component with the most segments:
+    std::vector<uint32_t> segmentCounts(graph.lats.size(), 0);
+    for (const RoadGraph::Segment& segment : graph.segments) {
+        segmentCounts[uf.find(segment.start)]++;
+    }
+    const auto largest = static_cast<uint32_t>(std::distance(segmentCounts.begin(), std::max_element(segmentCounts.begin(), segmentCounts.end())));
+
+    // Keep only segments and coordinates of the largest component:
+    std::vector<uint32_t> newIds(graph.lats.size(), std::numeric_limits<uint32_t>::max());
+    RoadGraph result;
+    result.segments.reserve(segmentCounts[largest]);
+    auto remap = [&](uint32_t id) {
+        if (newIds[id] == std::numeric_limits<uint32_t>::max()) {
+            newIds[id] = static_cast<uint32_t>(result.lats.size());
+            result.lats.push_back(graph.lats[id]);
+            result.longs.push_back(graph.longs[id]);
+        }
+        return newIds[id];
+    };
+    for (const RoadGraph::Segment& segment : graph.segments) {
+        if (uf.find(segment.start) == largest) {
+            const uint32_t start = remap(segment.start);
+            result.segments.push_back(RoadGraph::Segment{start, remap(segment.end)});
+        }
+    }
+
+    SPDLOG_INFO("Reduced to {} connected road pieces.", result.segments.size());
+    graph = std::move(result);
+}
+
+BuiltMap build_map(const RoadGraph& graph) {
+    BuiltMap map;
+    if (graph.segments.empty()) {
+        return map;
+    }
+
+    // Project to meters:
+    const double minLat = *std::min_element(graph.lats.begin(), graph.lats.end());
+    const double minLong = *std::min_element(graph.longs.begin(), graph.longs.end());
+    std::vector<double> distLats;
+    std::vector<double> distLongs;
+    project(graph.lats, minLat, distLats);
+    project(graph.longs, minLong, distLongs);
+    map.width = static_cast<float>(*std::max_element(distLats.begin(), distLats.end()));
+    map.height = static_cast<float>(*std::max_element(distLongs.begin(), distLongs.end()));
+
+    // Roads connected to each coordinate in the compressed sparse row format:
+    std::vector<uint32_t> connStarts(graph.lats.size() + 1, 0);
+    for (const RoadGraph::Segment& segment : graph.segments) {
+        connStarts[segment.start + 1]++;
+        connStarts[segment.end + 1]++;
+    }
+    for (size_t i = 1; i < connStarts.size(); i++) {
+        connStarts[i] += connStarts[i - 1];
+    }
+    map.connections.resize(connStarts.back());
+    std::vector<uint32_t> connFill(connStarts.begin(), connStarts.end() - 1);
+    for (size_t i = 0; i < graph.segments.size(); i++) {
+        map.connections[connFill[graph.segments[i].start]++] = static_cast<unsigned int>(i);
+        map.connections[connFill[graph.segments[i].end]++] = static_cast<unsigned int>(i);
+    }
+
+    auto coordinate = [&](uint32_t id) {
+        return sim::Coordinate{sim::Vec2{static_cast<float>(distLats[id]), static_cast<float>(distLongs[id])}, connStarts[id], connStarts[id + 1] - connStarts[id]};
+    };
+    map.roads.reserve(graph.segments.size());
+    for (const RoadGraph::Segment& segment : graph.segments) {
+        map.roads.push_back(sim::Road{coordinate(segment.start), coordinate(segment.end)});
+        map.startLats.push_back(graph.lats[segment.start]);
+        map.startLongs.push_back(graph.longs[segment.start]);
+        map.endLats.push_back(graph.lats[segment.end]);
+        map.endLongs.push_back(graph.longs[segment.end]);
+    }
+
+    SPDLOG_INFO("Found {} connections. Suggested map size at least: {}x{} meters.", map.connections.size(), map.width, map.height);
+    return map;
+}
+
+bool write_json(const BuiltMap& map, const std::filesystem::path& path) {
+    SPDLOG_INFO("Writing JSON map to '{}'...", path.string());
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open()) {
+        SPDLOG_ERROR("Failed to open '{}' for writing.", path.string());
+        return false;
+    }
+    file.precision(std::numeric_limits<double>::max_digits10);
+
+    // Written by hand instead of through a DOM to keep the memory footprint small:
+    file << R"({"minDistLat":0,"maxDistLat":)" << map.width << R"(,"minDistLong":0,"maxDistLong":)" << map.height << R"(,"roads":[)";
+    for (size_t i = 0; i < map.roads.size(); i++) {
+        const sim::Road& road = map.roads[i];
+        if (i > 0) {
+            file << ',';
+        }
+        file << R"({"start":{"lat":)" << map.startLats[i] << R"(,"long":)" << map.startLongs[i] << R"(,"distLat":)" << road.start.pos.x << R"(,"distLong":)" << road.start.pos.y
+             << R"(},"end":{"lat":)" << map.endLats[i] << R"(,"long":)" << map.endLongs[i] << R"(,"distLat":)" << road.end.pos.x << R"(,"distLong":)" << road.end.pos.y
+             << R"(},"connIndexStart":)" << road.start.connectedIndex << R"(,"connCountStart":)" << road.start.connectedCount
+             << R"(,"connIndexEnd":)" << road.end.connectedIndex << R"(,"connCountEnd":)" << road.end.connectedCount << '}';
+    }
+    file << R"(],"connectionRoadIndexList":[)";
+    for (size_t i = 0; i < map.connections.size(); i++) {
+        if (i > 0) {
+            file << ',';
+        }
+        file << map.connections[i];
+    }
+    file << "]}";
+    file.close();
+
+    if (!file) {
+        SPDLOG_ERROR("Failed to write JSON map to '{}'.", path.string());
+        return false;
+    }
+    SPDLOG_INFO("JSON map written to '{}'.", path.string());
+    return true;
+}
+}  // namespace mapbuild
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "sim/Map.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace mapbuild {
+/**
+ * Road network parsed from GeoJSON.
+ * Every distinct coordinate is stored once. Segments reference coordinates by index.
+ **/
+struct RoadGraph {
+    /**
+     * Coordinates as structure of arrays so projecting them vectorizes.
+     * Like the original map generator, the first value of a GeoJSON position is treated as 'lat' and the second one as 'long'.
+     **/
+    std::vector<double> lats;
+    std::vector<double> longs;
+
+    struct Segment {
+        uint32_t start{0};
+        uint32_t end{0};
+    };
+    std::vector<Segment> segments;
+};
+
+/**
+ * The final map in the layout expected by sim::Map.
+ **/
+struct BuiltMap {
+    float width{0};
+    float height{0};
+
+    /**
+     * Original coordinates of the road start and end points. Only required for the JSON output.
+     **/
+    std::vector<double> startLats;
+    std::vector<double> startLongs;
+    std::vector<double> endLats;
+    std::vector<double> endLongs;
+
+    std::vector<sim::Road> roads;
+    std::vector<unsigned int> connections;
+};
+
+/**
+ * Parses all LineString and MultiLineString features of the given GeoJSON file using threadCount threads.
+ * Duplicate coordinates get merged, segments where start == end and duplicate segments get dropped.
+ * Returns std::nullopt in case the file could not be read.
+ * Throws a std::runtime_error in case the file is no valid GeoJSON feature collection.
+ **/
+std::optional<RoadGraph> parse_geojson(const std::filesystem::path& path, size_t threadCount);
+
+/**
+ * Removes all segments that are not part of the largest connected component.
+ **/
+void remove_disconnected(RoadGraph& graph);
+
+/**
+ * Projects all coordinates to meters relative to the minimum lat and long and builds the connection lists.
+ **/
+BuiltMap build_map(const RoadGraph& graph);
+
+bool write_json(const BuiltMap& map, const std::filesystem::path& path);
+}  // namespace mapbuild
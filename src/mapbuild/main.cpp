@@ -0,0 +1,59 @@
+#include "MapBuilder.hpp"
+#include "logger/Logger.hpp"
+#include "sim/MapBinary.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+
+/**
+ * Builds a map out of a GeoJSON file containing roads as LineString or MultiLineString features.
+ * Usage: msim-mapbuild <input.geojson> <output.json|output.msim> [--threads <count>]
+ * The output format gets selected based on the extension of the output path.
+ **/
+int main(int argc, char** argv) {
+    const std::span<char*> args(argv, static_cast<size_t>(argc));
+    size_t threadCount = std::max(std::thread::hardware_concurrency(), 1U);
+    bool validArgs = args.size() == 3;
+    if (args.size() == 5 && std::strcmp(args[3], "--threads") == 0) {
+        // Parsed without exceptions, so invalid counts end up with the usage instead of a crash:
+        const std::string_view threads = args[4];
+        const auto [end, ec] = std::from_chars(threads.data(), threads.data() + threads.size(), threadCount);
+        validArgs = ec == std::errc() && end == threads.data() + threads.size() && threadCount > 0;
+    }
+    if (!validArgs) {
+        SPDLOG_ERROR("Usage: {} <input.geojson> <output.json|output{}> [--threads <count>]", args[0], sim::map_binary::FILE_EXTENSION);
+        return EXIT_FAILURE;
+    }
+    const std::filesystem::path inPath = args[1];
+    const std::filesystem::path outPath = args[2];
+
+    try {
+        std::optional<mapbuild::RoadGraph> graph = mapbuild::parse_geojson(inPath, threadCount);
+        if (!graph) {
+            return EXIT_FAILURE;
+        }
+        mapbuild::remove_disconnected(*graph);
+        const mapbuild::BuiltMap map = mapbuild::build_map(*graph);
+        graph = std::nullopt;
+
+        bool success = false;
+        if (sim::map_binary::is_binary_map_path(outPath)) {
+            success = sim::map_binary::write(map.width, map.height, map.roads, map.connections, outPath);
+        } else {
+            success = mapbuild::write_json(map, outPath);
+        }
+        return success ? EXIT_SUCCESS : EXIT_FAILURE;
+    } catch (const std::exception& e) {
+        SPDLOG_ERROR("Failed to build map from '{}': {}", inPath.string(), e.what());
+        return EXIT_FAILURE;
+    }
+}
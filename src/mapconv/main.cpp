@@ -0,0 +1,46 @@
+#include "logger/Logger.hpp"
+#include "sim/Map.hpp"
+#include "sim/MapBinary.hpp"
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <span>
+
+/**
+ * Converts a JSON map into the binary map format.
+ * Usage: msim-mapconv <input.json> [output.msim]
+ * In case no output path is given, the input path with its extension replaced by sim::map_binary::FILE_EXTENSION is used.
+ **/
+int main(int argc, char** argv) {
+    const std::span<char*> args(argv, static_cast<size_t>(argc));
+    if (args.size() < 2 || args.size() > 3) {
+        SPDLOG_ERROR("Usage: {} <input.json> [output{}]", args[0], sim::map_binary::FILE_EXTENSION);
+        return EXIT_FAILURE;
+    }
+
+    const std::filesystem::path inPath = args[1];
+    std::filesystem::path outPath = inPath;
+    if (args.size() == 3) {
+        outPath = args[2];
+    } else {
+        outPath.replace_extension(sim::map_binary::FILE_EXTENSION);
+    }
+
+    if (sim::map_binary::is_binary_map_path(inPath)) {
+        SPDLOG_ERROR("'{}' already is a binary map.", inPath.string());
+        return EXIT_FAILURE;
+    }
+
+    std::shared_ptr<sim::Map> map{nullptr};
+    try {
+        map = sim::Map::load_from_json_file(inPath);
+    } catch (const std::exception& e) {
+        SPDLOG_ERROR("Failed to load '{}': {}", inPath.string(), e.what());
+        return EXIT_FAILURE;
+    }
+    if (!map) {
+        return EXIT_FAILURE;
+    }
+    return map->save_to_binary_file(outPath) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -12,36 +12,36 @@ struct Vec2 {
     static Vec2 random_vec(float x_min, float x_max, float y_min, float y_max);
 } __attribute__((aligned(8))) __attribute__((__packed__));
 
-struct Vec4U {
-    unsigned int x{0};
-    unsigned int y{0};
-    unsigned int z{0};
-    unsigned int w{0};
-
-    static Vec4U random_vec();
-} __attribute__((aligned(16))) __attribute__((__packed__));
-
-struct Rgba {
-    float r{0};
-    float g{0};
-    float b{0};
-    float a{0};
-
-    static Rgba random_color();
-} __attribute__((aligned(16))) __attribute__((__packed__));
-
-struct Entity {
-    Rgba color{1.0, 0.0, 0.0, 1.0};
-    Vec4U randomState{};
-    Vec2 pos{};
+struct EntityMotion {
     Vec2 target{};
     Vec2 direction{};
-    unsigned int roadIndex{0};
-    unsigned int initialized{0};
-
- public:
-    Entity(Rgba&& color, Vec4U&& randomState, Vec2&& pos, Vec2&& target, Vec2&& direction, unsigned int roadIndex, bool initialized);
+} __attribute__((aligned(16))) __attribute__((__packed__));
 
-    static int random_int();
-} __attribute__((aligned(64))) __attribute__((__packed__));
+/**
+ * Entity states that can be rendered.
+ * Has to match the PALETTE_* constants inside render_entities.comp.
+ **/
+enum class EntityPaletteIndex : uint32_t {
+    UNINITIALIZED = 0,
+    NO_COLLISION = 1,
+    COLLISION = 2,
+    COUNT = 3
+};
+
+/**
+ * Compact per entity record written by render_entities.comp.
+ * This is the only entity data that gets retrieved from the GPU for rendering.
+ **/
+struct RenderEntity {
+    /**
+     * Position relative to the world size, quantized to [0, 65535].
+     **/
+    uint16_t x{0};
+    uint16_t y{0};
+
+    /**
+     * One of EntityPaletteIndex. Gets resolved to a color by entity.vert.
+     **/
+    uint32_t paletteIndex{0};
+} __attribute__((aligned(4))) __attribute__((__packed__));
 }  // namespace sim
\ No newline at end of file
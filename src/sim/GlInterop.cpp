@@ -0,0 +1,252 @@
+#include "GlInterop.hpp"
+#include "logger/Logger.hpp"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <cassert>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+
+namespace sim::gl_interop {
+namespace {
+bool get_devices(kp::Manager& mgr, std::shared_ptr<vk::PhysicalDevice>& physicalDevice, std::shared_ptr<vk::Device>& device) {
+    physicalDevice = mgr.getVkPhysicalDevice();
+    device = mgr.getVkDevice();
+    return physicalDevice && device;
+}
+
+/**
+ * Kompute evaluates all sequences on the first queue of the first queue family supporting compute, in case no queue families get passed to its Manager.
+ **/
+std::optional<uint32_t> find_compute_queue_family(const vk::PhysicalDevice& physicalDevice) {
+    const std::vector<vk::QueueFamilyProperties> queueFamilies = physicalDevice.getQueueFamilyProperties();
+    for (uint32_t i = 0; i < queueFamilies.size(); i++) {
+        if (queueFamilies[i].queueFlags & vk::QueueFlagBits::eCompute) {
+            return i;
+        }
+    }
+    return std::nullopt;
+}
+
+bool supports_required_extensions(const vk::PhysicalDevice& physicalDevice) {
+    const std::vector<vk::ExtensionProperties> extensions = physicalDevice.enumerateDeviceExtensionProperties();
+    return std::all_of(REQUIRED_DEVICE_EXTENSIONS.begin(), REQUIRED_DEVICE_EXTENSIONS.end(), [&extensions](std::string_view required) {
+        return std::any_of(extensions.begin(), extensions.end(), [required](const vk::ExtensionProperties& ext) { return std::string_view(ext.extensionName.data()) == required; });
+    });
+}
+
+std::optional<uint32_t> find_memory_type(const vk::PhysicalDevice& physicalDevice, uint32_t typeBits, vk::MemoryPropertyFlags properties) {
+    const vk::PhysicalDeviceMemoryProperties memoryProperties = physicalDevice.getMemoryProperties();
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+        if ((typeBits & (1U << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+    return std::nullopt;
+}
+vk::Semaphore create_exportable_semaphore(const vk::Device& device) {
+    vk::ExportSemaphoreCreateInfo exportInfo{vk::ExternalSemaphoreHandleTypeFlagBits::eOpaqueFd};
+    vk::SemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.pNext = &exportInfo;
+    return device.createSemaphore(semaphoreInfo);
+}
+
+/**
+ * Returns -1 in case exporting failed.
+ **/
+int export_semaphore(const vk::Device& device, vk::Semaphore semaphore) {
+    // Extension function, so it is not part of the statically linked loader:
+    // NOLINTNEXTLINE (cppcoreguidelines-pro-type-reinterpret-cast)
+    auto getSemaphoreFd = reinterpret_cast<PFN_vkGetSemaphoreFdKHR>(device.getProcAddr("vkGetSemaphoreFdKHR"));
+    if (!getSemaphoreFd) {
+        SPDLOG_ERROR("Failed to export semaphore. 'vkGetSemaphoreFdKHR' not found.");
+        return -1;
+    }
+
+    int fd = -1;
+    const VkSemaphoreGetFdInfoKHR fdInfo{VK_STRUCTURE_TYPE_SEMAPHORE_GET_FD_INFO_KHR, nullptr, static_cast<VkSemaphore>(semaphore), VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT};
+    if (getSemaphoreFd(static_cast<VkDevice>(device), &fdInfo, &fd) != VK_SUCCESS) {
+        SPDLOG_ERROR("Failed to export semaphore. 'vkGetSemaphoreFdKHR' failed.");
+        return -1;
+    }
+    return fd;
+}
+}  // namespace
+
+SharedBuffer::SharedBuffer(std::shared_ptr<vk::PhysicalDevice> physicalDevice, std::shared_ptr<vk::Device> device, vk::Buffer buffer, vk::DeviceMemory memory, uint64_t size, uint64_t memorySize, uint32_t queueFamilyIndex) : physicalDevice(std::move(physicalDevice)),
+                                                                                                                                                                                                                        device(std::move(device)),
+                                                                                                                                                                                                                        buffer(buffer),
+                                                                                                                                                                                                                        memory(memory),
+                                                                                                                                                                                                                        size(size),
+                                                                                                                                                                                                                        memorySize(memorySize),
+                                                                                                                                                                                                                        queueFamilyIndex(queueFamilyIndex) {}
+
+SharedBuffer::~SharedBuffer() {
+    device->destroyBuffer(buffer);
+    device->freeMemory(memory);
+}
+
+std::unique_ptr<SharedBuffer> SharedBuffer::create(kp::Manager& mgr, uint64_t size) {
+    std::shared_ptr<vk::PhysicalDevice> physicalDevice{nullptr};
+    std::shared_ptr<vk::Device> device{nullptr};
+    if (!get_devices(mgr, physicalDevice, device)) {
+        SPDLOG_INFO("Vulkan OpenGL interop unavailable. Kompute has no device.");
+        return nullptr;
+    }
+    if (!supports_required_extensions(*physicalDevice)) {
+        SPDLOG_INFO("Vulkan OpenGL interop unavailable. The device does not support exporting memory and semaphores.");
+        return nullptr;
+    }
+    std::optional<uint32_t> queueFamilyIndex = find_compute_queue_family(*physicalDevice);
+    if (!queueFamilyIndex) {
+        SPDLOG_INFO("Vulkan OpenGL interop unavailable. No compute queue family found.");
+        return nullptr;
+    }
+
+    // Buffer:
+    vk::ExternalMemoryBufferCreateInfo externalInfo{vk::ExternalMemoryHandleTypeFlagBits::eOpaqueFd};
+    vk::BufferCreateInfo bufferInfo{{}, size, vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eStorageBuffer, vk::SharingMode::eExclusive};
+    bufferInfo.pNext = &externalInfo;
+    vk::Buffer buffer = device->createBuffer(bufferInfo);
+
+    // Memory:
+    const vk::MemoryRequirements requirements = device->getBufferMemoryRequirements(buffer);
+    std::optional<uint32_t> memoryType = find_memory_type(*physicalDevice, requirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal);
+    if (!memoryType) {
+        SPDLOG_INFO("Vulkan OpenGL interop unavailable. No device local memory type for exporting found.");
+        device->destroyBuffer(buffer);
+        return nullptr;
+    }
+    vk::ExportMemoryAllocateInfo exportInfo{vk::ExternalMemoryHandleTypeFlagBits::eOpaqueFd};
+    vk::MemoryAllocateInfo allocateInfo{requirements.size, *memoryType};
+    allocateInfo.pNext = &exportInfo;
+    vk::DeviceMemory memory = device->allocateMemory(allocateInfo);
+    device->bindBufferMemory(buffer, memory, 0);
+
+    SPDLOG_INFO("Shared buffer with {} bytes for Vulkan OpenGL interop created.", size);
+    return std::make_unique<SharedBuffer>(std::move(physicalDevice), std::move(device), buffer, memory, size, requirements.size, *queueFamilyIndex);
+}
+
+std::optional<SharedBufferHandle> SharedBuffer::export_handle() const {
+    // Extension function, so it is not part of the statically linked loader:
+    // NOLINTNEXTLINE (cppcoreguidelines-pro-type-reinterpret-cast)
+    auto getMemoryFd = reinterpret_cast<PFN_vkGetMemoryFdKHR>(device->getProcAddr("vkGetMemoryFdKHR"));
+    if (!getMemoryFd) {
+        SPDLOG_ERROR("Failed to export shared buffer. 'vkGetMemoryFdKHR' not found.");
+        return std::nullopt;
+    }
+
+    SharedBufferHandle handle;
+    handle.size = size;
+    handle.memorySize = memorySize;
+    const VkMemoryGetFdInfoKHR fdInfo{VK_STRUCTURE_TYPE_MEMORY_GET_FD_INFO_KHR, nullptr, static_cast<VkDeviceMemory>(memory), VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT};
+    if (getMemoryFd(static_cast<VkDevice>(*device), &fdInfo, &handle.fd) != VK_SUCCESS) {
+        SPDLOG_ERROR("Failed to export shared buffer. 'vkGetMemoryFdKHR' failed.");
+        return std::nullopt;
+    }
+
+    const vk::StructureChain<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceIDProperties> properties = physicalDevice->getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceIDProperties>();
+    const vk::PhysicalDeviceIDProperties& idProperties = properties.get<vk::PhysicalDeviceIDProperties>();
+    std::copy_n(idProperties.deviceUUID.begin(), UUID_SIZE, handle.deviceUuid.begin());
+    std::copy_n(idProperties.driverUUID.begin(), UUID_SIZE, handle.driverUuid.begin());
+    return handle;
+}
+
+vk::Buffer SharedBuffer::get_buffer() const {
+    return buffer;
+}
+
+uint64_t SharedBuffer::get_size() const {
+    return size;
+}
+
+uint32_t SharedBuffer::get_queue_family_index() const {
+    return queueFamilyIndex;
+}
+
+SharedBufferSync::SharedBufferSync(std::shared_ptr<vk::Device> device, vk::Queue queue, vk::Semaphore ready, vk::Semaphore released) : device(std::move(device)),
+                                                                                                                                       queue(queue),
+                                                                                                                                       ready(ready),
+                                                                                                                                       released(released) {}
+
+SharedBufferSync::~SharedBufferSync() {
+    device->destroySemaphore(released);
+    device->destroySemaphore(ready);
+}
+
+std::unique_ptr<SharedBufferSync> SharedBufferSync::create(kp::Manager& mgr) {
+    std::shared_ptr<vk::PhysicalDevice> physicalDevice{nullptr};
+    std::shared_ptr<vk::Device> device{nullptr};
+    if (!get_devices(mgr, physicalDevice, device) || !supports_required_extensions(*physicalDevice)) {
+        return nullptr;
+    }
+    std::optional<uint32_t> queueFamilyIndex = find_compute_queue_family(*physicalDevice);
+    if (!queueFamilyIndex) {
+        return nullptr;
+    }
+
+    const vk::Queue queue = device->getQueue(*queueFamilyIndex, 0);
+    const vk::Semaphore ready = create_exportable_semaphore(*device);
+    const vk::Semaphore released = create_exportable_semaphore(*device);
+    return std::make_unique<SharedBufferSync>(std::move(device), queue, ready, released);
+}
+
+std::optional<SharedBufferSyncHandle> SharedBufferSync::export_handle() const {
+    SharedBufferSyncHandle handle;
+    handle.readyFd = export_semaphore(*device, ready);
+    handle.releasedFd = export_semaphore(*device, released);
+    if (handle.readyFd < 0 || handle.releasedFd < 0) {
+        if (handle.readyFd >= 0) {
+            close(handle.readyFd);
+        }
+        if (handle.releasedFd >= 0) {
+            close(handle.releasedFd);
+        }
+        return std::nullopt;
+    }
+    return handle;
+}
+
+void SharedBufferSync::wait_released() const {
+    // Only the copies into the shared buffers have to wait:
+    const vk::PipelineStageFlags waitStage = vk::PipelineStageFlagBits::eTransfer;
+    vk::SubmitInfo submitInfo{};
+    submitInfo.setWaitSemaphores(released);
+    submitInfo.setWaitDstStageMask(waitStage);
+    queue.submit(submitInfo);
+}
+
+void SharedBufferSync::signal_ready() const {
+    vk::SubmitInfo submitInfo{};
+    submitInfo.setSignalSemaphores(ready);
+    queue.submit(submitInfo);
+}
+
+OpCopyToSharedBuffer::OpCopyToSharedBuffer(std::shared_ptr<kp::Tensor> tensor, const SharedBuffer* sharedBuffer) : tensor(std::move(tensor)),
+                                                                                                                 sharedBuffer(sharedBuffer) {
+    assert(this->tensor);
+    assert(this->sharedBuffer);
+}
+
+void OpCopyToSharedBuffer::record(const vk::CommandBuffer& commandBuffer) {
+    // Acquire the shared buffer from OpenGL. The previous contents get overwritten anyway:
+    const uint32_t queueFamilyIndex = sharedBuffer->get_queue_family_index();
+    const vk::BufferMemoryBarrier acquire{{}, vk::AccessFlagBits::eTransferWrite, VK_QUEUE_FAMILY_EXTERNAL, queueFamilyIndex, sharedBuffer->get_buffer(), 0, VK_WHOLE_SIZE};
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, nullptr, acquire, nullptr);
+
+    // Wait for the shader writing the tensor:
+    tensor->recordPrimaryBufferMemoryBarrier(commandBuffer, vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eTransferRead, vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eTransfer);
+
+    const vk::BufferCopy region{0, 0, std::min(static_cast<uint64_t>(tensor->memorySize()), sharedBuffer->get_size())};
+    commandBuffer.copyBuffer(tensor->constructDescriptorBufferInfo().buffer, sharedBuffer->get_buffer(), 1, &region);
+
+    // Release it to OpenGL again, which acquires it by waiting for the ready semaphore of the SharedBufferSync:
+    const vk::BufferMemoryBarrier release{vk::AccessFlagBits::eTransferWrite, {}, queueFamilyIndex, VK_QUEUE_FAMILY_EXTERNAL, sharedBuffer->get_buffer(), 0, VK_WHOLE_SIZE};
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe, {}, nullptr, release, nullptr);
+}
+
+void OpCopyToSharedBuffer::preEval(const vk::CommandBuffer& /*commandBuffer*/) {}
+
+void OpCopyToSharedBuffer::postEval(const vk::CommandBuffer& /*commandBuffer*/) {}
+}  // namespace sim::gl_interop
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <kompute/Manager.hpp>
+#include <kompute/Tensor.hpp>
+#include <kompute/operations/OpBase.hpp>
+#include <memory>
+#include <optional>
+
+/**
+ * Sharing simulation buffers with OpenGL through external memory (VK_KHR_external_memory_fd and GL_EXT_memory_object_fd).
+ * Everything in here is optional. In case either side lacks the required extensions, callers fall back to copying via the host.
+ *
+ * The buffers get handed over on the device through a pair of exported semaphores (VK_KHR_external_semaphore_fd and GL_EXT_semaphore_fd).
+ * Vulkan signals the ready semaphore after copying into the shared buffers, OpenGL waits for it before reading them
+ * and signals the released semaphore once done, which Vulkan waits for before the next copy.
+ * The host only orders the submissions, so every wait gets submitted after the signal it waits for.
+ **/
+namespace sim::gl_interop {
+constexpr size_t UUID_SIZE = 16;
+
+/**
+ * Device extensions the Kompute device has to be created with for sharing buffers.
+ **/
+constexpr std::array<const char*, 4> REQUIRED_DEVICE_EXTENSIONS{"VK_KHR_external_memory", "VK_KHR_external_memory_fd", "VK_KHR_external_semaphore", "VK_KHR_external_semaphore_fd"};
+
+/**
+ * Everything OpenGL requires to import a shared buffer.
+ **/
+struct SharedBufferHandle {
+    /**
+     * Opaque file descriptor of the memory. Ownership gets transferred to whoever imports it.
+     **/
+    int fd{-1};
+    uint64_t size{0};
+    /**
+     * Size of the whole allocation backing the buffer. Might be larger than size.
+     **/
+    uint64_t memorySize{0};
+    /**
+     * Used for ensuring OpenGL runs on the same device and driver as Vulkan.
+     **/
+    std::array<uint8_t, UUID_SIZE> deviceUuid{};
+    std::array<uint8_t, UUID_SIZE> driverUuid{};
+};
+
+/**
+ * Device local buffer allocated with exportable memory on the Kompute device.
+ **/
+class SharedBuffer {
+ private:
+    std::shared_ptr<vk::PhysicalDevice> physicalDevice{nullptr};
+    std::shared_ptr<vk::Device> device{nullptr};
+    vk::Buffer buffer{};
+    vk::DeviceMemory memory{};
+    uint64_t size{0};
+    uint64_t memorySize{0};
+    uint32_t queueFamilyIndex{0};
+
+ public:
+    SharedBuffer(std::shared_ptr<vk::PhysicalDevice> physicalDevice, std::shared_ptr<vk::Device> device, vk::Buffer buffer, vk::DeviceMemory memory, uint64_t size, uint64_t memorySize, uint32_t queueFamilyIndex);
+    SharedBuffer(SharedBuffer& other) = delete;
+    SharedBuffer(SharedBuffer&& old) = delete;
+
+    ~SharedBuffer();
+
+    SharedBuffer& operator=(SharedBuffer& other) = delete;
+    SharedBuffer& operator=(SharedBuffer&& old) = delete;
+
+    /**
+     * Returns nullptr in case the device does not support exporting memory.
+     **/
+    static std::unique_ptr<SharedBuffer> create(kp::Manager& mgr, uint64_t size);
+
+    /**
+     * Exports a new file descriptor for the buffer memory.
+     * Returns std::nullopt in case exporting failed.
+     **/
+    [[nodiscard]] std::optional<SharedBufferHandle> export_handle() const;
+
+    [[nodiscard]] vk::Buffer get_buffer() const;
+    [[nodiscard]] uint64_t get_size() const;
+    /**
+     * The queue family Kompute evaluates its sequences on. Owns the buffer while Vulkan writes it.
+     **/
+    [[nodiscard]] uint32_t get_queue_family_index() const;
+};
+
+/**
+ * Everything OpenGL requires to import the semaphores of a SharedBufferSync.
+ * Ownership of both file descriptors gets transferred to whoever imports them.
+ **/
+struct SharedBufferSyncHandle {
+    int readyFd{-1};
+    int releasedFd{-1};
+};
+
+/**
+ * Hands all shared buffers over between Vulkan and OpenGL on the device.
+ * Submits empty batches to the queue Kompute evaluates its sequences on, so they are ordered with the sequences by submission order.
+ * Like the sequences, it must only be used from the thread evaluating them.
+ **/
+class SharedBufferSync {
+ private:
+    std::shared_ptr<vk::Device> device{nullptr};
+    vk::Queue queue{};
+    /**
+     * Signaled by Vulkan once the shared buffers got written.
+     **/
+    vk::Semaphore ready{};
+    /**
+     * Signaled by OpenGL once it is done reading the shared buffers.
+     **/
+    vk::Semaphore released{};
+
+ public:
+    SharedBufferSync(std::shared_ptr<vk::Device> device, vk::Queue queue, vk::Semaphore ready, vk::Semaphore released);
+    SharedBufferSync(SharedBufferSync& other) = delete;
+    SharedBufferSync(SharedBufferSync&& old) = delete;
+
+    ~SharedBufferSync();
+
+    SharedBufferSync& operator=(SharedBufferSync& other) = delete;
+    SharedBufferSync& operator=(SharedBufferSync&& old) = delete;
+
+    /**
+     * Returns nullptr in case the device does not support exporting semaphores.
+     **/
+    static std::unique_ptr<SharedBufferSync> create(kp::Manager& mgr);
+
+    /**
+     * Exports new file descriptors for both semaphores.
+     * Returns std::nullopt in case exporting failed.
+     **/
+    [[nodiscard]] std::optional<SharedBufferSyncHandle> export_handle() const;
+
+    /**
+     * Makes all transfers submitted afterwards wait until OpenGL signaled the released semaphore.
+     * OpenGL has to have submitted the signal already.
+     **/
+    void wait_released() const;
+    /**
+     * Signals the ready semaphore once everything submitted before completed.
+     **/
+    void signal_ready() const;
+};
+
+/**
+ * Copies the whole primary buffer of a tensor into a shared buffer on the device.
+ * Acquires the shared buffer from OpenGL before and releases it to OpenGL after the copy.
+ **/
+class OpCopyToSharedBuffer : public kp::OpBase {
+ private:
+    std::shared_ptr<kp::Tensor> tensor;
+    const SharedBuffer* sharedBuffer;
+
+ public:
+    OpCopyToSharedBuffer(std::shared_ptr<kp::Tensor> tensor, const SharedBuffer* sharedBuffer);
+    OpCopyToSharedBuffer(OpCopyToSharedBuffer& other) = delete;
+    OpCopyToSharedBuffer(OpCopyToSharedBuffer&& old) = delete;
+
+    ~OpCopyToSharedBuffer() override = default;
+
+    OpCopyToSharedBuffer& operator=(OpCopyToSharedBuffer& other) = delete;
+    OpCopyToSharedBuffer& operator=(OpCopyToSharedBuffer&& old) = delete;
+
+    void record(const vk::CommandBuffer& commandBuffer) override;
+    void preEval(const vk::CommandBuffer& commandBuffer) override;
+    void postEval(const vk::CommandBuffer& commandBuffer) override;
+};
+}  // namespace sim::gl_interop
@@ -0,0 +1,8 @@
+#include "GpuReorder.hpp"
+#include <cstddef>
+
+namespace sim::gpu_reorder {
+size_t calc_sort_chunk_count(size_t entityCount) {
+    return (entityCount + SORT_CHUNK_SIZE - 1) / SORT_CHUNK_SIZE;
+}
+}  // namespace sim::gpu_reorder
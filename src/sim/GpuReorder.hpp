@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sim::gpu_reorder {
+/**
+ * Number of entities each invocation of the radix sort histogram and scatter passes is responsible for.
+ * Has to match REORDER_SORT_CHUNK_SIZE inside reorder.comp.
+ **/
+constexpr size_t SORT_CHUNK_SIZE = 1024;
+/**
+ * Number of bits sorted per radix sort step.
+ * The 32 bit Morton codes get sorted in 32 / RADIX_BITS steps.
+ **/
+constexpr size_t RADIX_BITS = 8;
+constexpr size_t RADIX_BUCKET_COUNT = static_cast<size_t>(1) << RADIX_BITS;
+constexpr size_t RADIX_STEP_COUNT = 32 / RADIX_BITS;
+/**
+ * Max number of uint32_t a single per entity attribute occupies inside the scratch buffer.
+ * Has to match REORDER_SCRATCH_STRIDE inside reorder.comp.
+ **/
+constexpr size_t SCRATCH_STRIDE = 5;
+
+enum class Pass : uint32_t {
+    KEYS = 0,
+    HISTOGRAM = 1,
+    SCAN_BUCKETS = 2,
+    SCAN_BUCKET_TOTALS = 3,
+    SCATTER = 4,
+    INVERT = 5,
+    GATHER = 6,
+    APPLY = 7,
+    REMAP_QUAD_TREE_NODES = 8,
+    UPDATE_SLOTS = 9
+};
+
+/**
+ * Per entity buffers that get permuted.
+ * Selected via PushConsts::reorderStep during the GATHER and APPLY passes.
+ * The collision bits do not have to be permuted since they get cleared before the next collision pass.
+ **/
+enum class Attribute : uint32_t {
+    POSITIONS = 0,
+    MOTIONS = 1,
+    ROAD_INDICES = 2,
+    STATES = 3,
+    IDS = 4,
+    QUAD_TREE_ENTITIES = 5
+};
+
+size_t calc_sort_chunk_count(size_t entityCount);
+}  // namespace sim::gpu_reorder
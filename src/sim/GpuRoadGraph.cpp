@@ -0,0 +1,148 @@
+#include "GpuRoadGraph.hpp"
+#include "RoadIndex.hpp"
+#include "logger/Logger.hpp"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sim::gpu_road_graph {
+namespace {
+/**
+ * The grid cell size used for the spatial join relative to the max distance.
+ * Larger cells result in less cells per road but more candidates per cell.
+ **/
+constexpr float GRID_CELL_SIZE_FACTOR = 4;
+
+float cross(float ax, float ay, float bx, float by) {
+    return (ax * by) - (ay * bx);
+}
+
+bool segments_intersect(const Vec2& p0, const Vec2& p1, const Vec2& q0, const Vec2& q1) {
+    float d0 = cross(p1.x - p0.x, p1.y - p0.y, q0.x - p0.x, q0.y - p0.y);
+    float d1 = cross(p1.x - p0.x, p1.y - p0.y, q1.x - p0.x, q1.y - p0.y);
+    float d2 = cross(q1.x - q0.x, q1.y - q0.y, p0.x - q0.x, p0.y - q0.y);
+    float d3 = cross(q1.x - q0.x, q1.y - q0.y, p1.x - q0.x, p1.y - q0.y);
+    return ((d0 > 0 && d1 < 0) || (d0 < 0 && d1 > 0)) && ((d2 > 0 && d3 < 0) || (d2 < 0 && d3 > 0));
+}
+
+struct Grid {
+    float cellSize{1};
+    size_t cellsX{1};
+    size_t cellsY{1};
+
+    /**
+     * Roads per cell in the compressed sparse row format.
+     **/
+    std::vector<uint32_t> cellStarts;
+    std::vector<uint32_t> cellRoads;
+
+    [[nodiscard]] size_t cell_x(float x) const {
+        return static_cast<size_t>(std::clamp(std::floor(x / cellSize), 0.0F, static_cast<float>(cellsX - 1)));
+    }
+
+    [[nodiscard]] size_t cell_y(float y) const {
+        return static_cast<size_t>(std::clamp(std::floor(y / cellSize), 0.0F, static_cast<float>(cellsY - 1)));
+    }
+};
+
+/**
+ * Calls func(cellIndex) for every grid cell the bounding box of the given road, extended by margin, overlaps.
+ **/
+template <typename Func>
+void for_each_cell(const Grid& grid, const Road& road, float margin, Func&& func) {
+    size_t minX = grid.cell_x(std::min(road.start.pos.x, road.end.pos.x) - margin);
+    size_t maxX = grid.cell_x(std::max(road.start.pos.x, road.end.pos.x) + margin);
+    size_t minY = grid.cell_y(std::min(road.start.pos.y, road.end.pos.y) - margin);
+    size_t maxY = grid.cell_y(std::max(road.start.pos.y, road.end.pos.y) + margin);
+    for (size_t y = minY; y <= maxY; y++) {
+        for (size_t x = minX; x <= maxX; x++) {
+            func((y * grid.cellsX) + x);
+        }
+    }
+}
+
+Grid build_grid(const Map& map, float cellSize) {
+    Grid grid;
+    grid.cellSize = cellSize;
+    grid.cellsX = std::max(static_cast<size_t>(std::ceil(map.width / cellSize)), static_cast<size_t>(1));
+    grid.cellsY = std::max(static_cast<size_t>(std::ceil(map.height / cellSize)), static_cast<size_t>(1));
+
+    // Count roads per cell:
+    grid.cellStarts.resize((grid.cellsX * grid.cellsY) + 1, 0);
+    for (const Road& road : map.roads) {
+        for_each_cell(grid, road, 0, [&grid](size_t cell) { grid.cellStarts[cell + 1]++; });
+    }
+
+    // Prefix sum:
+    for (size_t i = 1; i < grid.cellStarts.size(); i++) {
+        grid.cellStarts[i] += grid.cellStarts[i - 1];
+    }
+
+    // Fill:
+    grid.cellRoads.resize(grid.cellStarts.back());
+    std::vector<uint32_t> cellFill(grid.cellStarts.begin(), grid.cellStarts.end() - 1);
+    for (size_t i = 0; i < map.roads.size(); i++) {
+        for_each_cell(grid, map.roads[i], 0, [&grid, &cellFill, i](size_t cell) { grid.cellRoads[cellFill[cell]++] = static_cast<uint32_t>(i); });
+    }
+    return grid;
+}
+}  // namespace
+
+float segment_distance(const Vec2& p0, const Vec2& p1, const Vec2& q0, const Vec2& q1) {
+    if (segments_intersect(p0, p1, q0, q1)) {
+        return 0;
+    }
+    return std::min({point_segment_distance(p0, q0, q1),
+                     point_segment_distance(p1, q0, q1),
+                     point_segment_distance(q0, p0, p1),
+                     point_segment_distance(q1, p0, p1)});
+}
+
+RoadNeighbours build_road_neighbours(const Map& map, float maxDistance) {
+    assert(maxDistance > 0);
+    SPDLOG_INFO("Building road neighbours for {} roads with a max distance of {} meters...", map.roads.size(), maxDistance);
+
+    const Grid grid = build_grid(map, maxDistance * GRID_CELL_SIZE_FACTOR);
+
+    RoadNeighbours result;
+    result.neighbourStarts.reserve(map.roads.size() + 1);
+
+    // Marks the last road a candidate has been checked for to prevent duplicate checks across cells:
+    std::vector<uint32_t> lastChecked(map.roads.size(), static_cast<uint32_t>(-1));
+    for (size_t i = 0; i < map.roads.size(); i++) {
+        const Road& road = map.roads[i];
+        const size_t first = result.neighbours.size();
+        result.neighbourStarts.push_back(static_cast<uint32_t>(first));
+
+        for_each_cell(grid, road, maxDistance, [&](size_t cell) {
+            for (uint32_t c = grid.cellStarts[cell]; c < grid.cellStarts[cell + 1]; c++) {
+                uint32_t candidate = grid.cellRoads[c];
+                if (candidate == i || lastChecked[candidate] == i) {
+                    continue;
+                }
+                lastChecked[candidate] = static_cast<uint32_t>(i);
+
+                const Road& other = map.roads[candidate];
+                if (segment_distance(road.start.pos, road.end.pos, other.start.pos, other.end.pos) < maxDistance) {
+                    result.neighbours.push_back(candidate);
+                }
+            }
+        });
+
+        // Sorted neighbours result in more coherent memory accesses on the GPU:
+        std::sort(result.neighbours.begin() + static_cast<std::ptrdiff_t>(first), result.neighbours.end());
+    }
+    result.neighbourStarts.push_back(static_cast<uint32_t>(result.neighbours.size()));
+
+    SPDLOG_INFO("Road neighbours built. Found {} neighbours ({:.2f} per road).", result.neighbours.size(), map.roads.empty() ? 0.0 : static_cast<double>(result.neighbours.size()) / static_cast<double>(map.roads.size()));
+    return result;
+}
+
+size_t calc_scan_chunk_count(size_t roadCount) {
+    return (roadCount + SCAN_CHUNK_SIZE - 1) / SCAN_CHUNK_SIZE;
+}
+}  // namespace sim::gpu_road_graph
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Map.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sim::gpu_road_graph {
+/**
+ * Number of roads each invocation of the first prefix sum pass is responsible for.
+ * Has to match ROAD_GRAPH_SCAN_CHUNK_SIZE inside road_graph.comp.
+ **/
+constexpr size_t SCAN_CHUNK_SIZE = 256;
+
+enum class Pass : uint32_t {
+    CLEAR = 0,
+    COUNT = 1,
+    SCAN_CHUNKS = 2,
+    SCAN_CHUNK_SUMS = 3,
+    SCAN_ADD = 4,
+    SCATTER = 5,
+    SORT = 6,
+    COLLIDE = 7
+};
+
+// NOLINTNEXTLINE (altera-struct-pack-align) Ignore alignment since we need a compact layout.
+struct Entity {
+    uint32_t index{0};
+    /**
+     * Distance from the start of the road the entity is currently on.
+     **/
+    float offset{0};
+} __attribute__((packed)) __attribute__((aligned(4)));
+
+/**
+ * Neighbouring roads in the compressed sparse row format.
+ * The neighbours of road i are neighbours[neighbourStarts[i]] until neighbours[neighbourStarts[i + 1]].
+ * The road itself is not part of its neighbour list.
+ **/
+struct RoadNeighbours {
+    std::vector<uint32_t> neighbourStarts;
+    std::vector<uint32_t> neighbours;
+};
+
+/**
+ * Performs a one time spatial join over all roads of the given map using a uniform grid
+ * and returns for every road all other roads that are closer than maxDistance.
+ **/
+RoadNeighbours build_road_neighbours(const Map& map, float maxDistance);
+
+/**
+ * Returns the shortest distance between the two given line segments.
+ **/
+float segment_distance(const Vec2& p0, const Vec2& p1, const Vec2& q0, const Vec2& q1);
+
+size_t calc_scan_chunk_count(size_t roadCount);
+}  // namespace sim::gpu_road_graph
@@ -1,176 +1,556 @@
 #include "Map.hpp"
+#include "MapBinary.hpp"
 #include "logger/Logger.hpp"
 #include "sim/Entity.hpp"
 #include "spdlog/spdlog.h"
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <limits>
 #include <memory>
 #include <nlohmann/json.hpp>
 #include <optional>
-#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace sim {
 Coordinate::Coordinate(Vec2 pos, unsigned int connectedIndex, unsigned int connectedCount) : pos(pos),
                                                                                              connectedIndex(connectedIndex),
                                                                                              connectedCount(connectedCount) {}
 
-Map::Map(float width, float height, std::vector<Road>&& roads, std::vector<RoadPiece>&& roadPieces, std::vector<unsigned int>&& connections) : width(width),
-                                                                                                                                               height(height),
-                                                                                                                                               roads(std::move(roads)),
-                                                                                                                                               roadPieces(std::move(roadPieces)),
-                                                                                                                                               connections(std::move(connections)) {
-    assert(roadPieces.size() == roads.size() * 2);
+namespace {
+/**
+ * Number of cells per axis of the Hilbert curve used for ordering roads.
+ **/
+constexpr uint32_t HILBERT_SIZE = 1U << 16;
+
+/**
+ * Returns the distance along a Hilbert curve of size HILBERT_SIZE x HILBERT_SIZE for the given cell.
+ **/
+uint64_t hilbert_index(uint32_t x, uint32_t y) {
+    uint64_t result = 0;
+    for (uint32_t s = HILBERT_SIZE / 2; s > 0; s /= 2) {
+        const uint32_t rx = (x & s) > 0 ? 1 : 0;
+        const uint32_t ry = (y & s) > 0 ? 1 : 0;
+        result += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+
+        // Rotate the quadrant:
+        if (ry == 0) {
+            if (rx == 1) {
+                x = HILBERT_SIZE - 1 - x;
+                y = HILBERT_SIZE - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return result;
 }
 
-std::shared_ptr<Map> Map::load_from_file(const std::filesystem::path& path) {
-    SPDLOG_INFO("Loading map from '{}'...", path.string());
-    if (!std::filesystem::exists(path)) {
-        SPDLOG_ERROR("Failed to open map from '{}'. File does not exist.", path.string());
-        return nullptr;
+/**
+ * Reorders roads so that road i becomes order[i] and rewrites the connections to match.
+ * Connections get laid out in the new road order, while the order inside each connection list stays the same.
+ * Throws a std::runtime_error in case a connection range or a connection is out of bounds. Roads and connections stay untouched in this case.
+ **/
+void reorder_roads(const std::vector<uint32_t>& order, std::vector<Road>& roads, std::vector<unsigned int>& connections) {
+    assert(order.size() == roads.size());
+    std::vector<uint32_t> newIndices(roads.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        newIndices[order[i]] = static_cast<uint32_t>(i);
     }
 
-    std::ifstream file(path);
-    if (!file.is_open()) {
-        SPDLOG_ERROR("Failed to open map from '{}'.", path.string());
-        return nullptr;
+    std::vector<Road> newRoads;
+    newRoads.reserve(roads.size());
+    std::vector<unsigned int> newConnections;
+    newConnections.reserve(connections.size());
+    auto moveConnections = [&](Coordinate& coord) {
+        const size_t start = newConnections.size();
+        const size_t end = static_cast<size_t>(coord.connectedIndex) + coord.connectedCount;
+        if (end > connections.size()) {
+            throw std::runtime_error("Failed to reorder roads. Road connections out of bounds.");
+        }
+        for (size_t i = coord.connectedIndex; i < end; i++) {
+            if (connections[i] >= roads.size()) {
+                throw std::runtime_error("Failed to reorder roads. Connection to an unknown road.");
+            }
+            newConnections.push_back(newIndices[connections[i]]);
+        }
+        coord.connectedIndex = static_cast<unsigned int>(start);
+    };
+    for (uint32_t oldIndex : order) {
+        Road& road = newRoads.emplace_back(roads[oldIndex]);
+        moveConnections(road.start);
+        moveConnections(road.end);
+    }
+    roads = std::move(newRoads);
+    connections = std::move(newConnections);
+}
+
+/**
+ * Sorts the given roads along a Hilbert curve over their midpoints and returns the previous index of each road.
+ **/
+std::vector<uint32_t> renumber_roads(float width, float height, std::vector<Road>& roads, std::vector<unsigned int>& connections) {
+    std::vector<uint64_t> keys(roads.size());
+    const float scaleX = width > 0 ? static_cast<float>(HILBERT_SIZE - 1) / width : 0;
+    const float scaleY = height > 0 ? static_cast<float>(HILBERT_SIZE - 1) / height : 0;
+    for (size_t i = 0; i < roads.size(); i++) {
+        const float midX = (roads[i].start.pos.x + roads[i].end.pos.x) / 2;
+        const float midY = (roads[i].start.pos.y + roads[i].end.pos.y) / 2;
+        const auto cellX = static_cast<uint32_t>(std::clamp(midX * scaleX, 0.0F, static_cast<float>(HILBERT_SIZE - 1)));
+        const auto cellY = static_cast<uint32_t>(std::clamp(midY * scaleY, 0.0F, static_cast<float>(HILBERT_SIZE - 1)));
+        keys[i] = hilbert_index(cellX, cellY);
     }
-    nlohmann::json json = nlohmann::json::parse(file);
 
-    if (!json.contains("maxDistLat")) {
-        throw std::runtime_error("Failed to parse map. 'maxDistLat' field missing.");
+    std::vector<uint32_t> order(roads.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = static_cast<uint32_t>(i);
     }
-    float width = 0;
-    json.at("maxDistLat").get_to(width);
+    // Stable, so loading an already sorted map results in the identity:
+    std::stable_sort(order.begin(), order.end(), [&keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+
+    reorder_roads(order, roads, connections);
+    return order;
+}
+}  // namespace
 
-    if (!json.contains("maxDistLong")) {
-        throw std::runtime_error("Failed to parse map. 'maxDistLong' field missing.");
+Map::Map(float width, float height, std::vector<Road>&& roads, std::vector<unsigned int>&& connections) : width(width),
+                                                                                                      height(height),
+                                                                                                      roads(std::move(roads)),
+                                                                                                      connections(std::move(connections)),
+                                                                                                      roadIds(renumber_roads(width, height, this->roads, this->connections)),
+                                                                                                      roadIdIndices(this->roads.size()),
+                                                                                                      roadIndex(this->roads) {
+    for (size_t i = 0; i < roadIds.size(); i++) {
+        roadIdIndices[roadIds[i]] = static_cast<uint32_t>(i);
     }
-    float height = 0;
-    json.at("maxDistLong").get_to(height);
+}
+
+namespace {
+/**
+ * Streaming JSON map parser that does not build a DOM.
+ * In COUNT mode only the number of roads and connections gets counted.
+ * In FILL mode roads and connections get appended directly to their output vectors.
+ *
+ * Expected layout:
+ * {"maxDistLat": 0, "maxDistLong": 0, "roads": [{"start": {"distLat": 0, "distLong": 0}, "end": {...}, "connIndexStart": 0, ...}], "connectionRoadIndexList": [0, ...]}
+ **/
+class MapSaxParser : public nlohmann::json_sax<nlohmann::json> {
+ public:
+    enum class Mode {
+        COUNT,
+        FILL
+    };
+
+ private:
+    /**
+     * All keys we are interested in. Everything else gets skipped.
+     **/
+    enum class Key {
+        UNKNOWN,
+        MAX_DIST_LAT,
+        MAX_DIST_LONG,
+        ROADS,
+        CONNECTION_ROAD_INDEX_LIST,
+        START,
+        END,
+        CONN_INDEX_START,
+        CONN_COUNT_START,
+        CONN_INDEX_END,
+        CONN_COUNT_END,
+        DIST_LAT,
+        DIST_LONG
+    };
 
+    // Nesting depth of the current value. Values of the root object are at depth 1:
+    static constexpr size_t DEPTH_ROOT = 1;
+    static constexpr size_t DEPTH_ROAD = 3;
+    static constexpr size_t DEPTH_COORDINATE = 4;
+
+    Mode mode;
+    size_t depth{0};
+
+    Key rootKey{Key::UNKNOWN};
+    Key roadKey{Key::UNKNOWN};
+    Key coordinateKey{Key::UNKNOWN};
+
+    std::optional<float> width{std::nullopt};
+    std::optional<float> height{std::nullopt};
+    bool roadsFound{false};
+    bool connectionsFound{false};
+
+    // The road currently being parsed:
+    std::optional<unsigned int> connIndexStart{std::nullopt};
+    std::optional<unsigned int> connCountStart{std::nullopt};
+    std::optional<unsigned int> connIndexEnd{std::nullopt};
+    std::optional<unsigned int> connCountEnd{std::nullopt};
+    std::optional<float> latStart{std::nullopt};
+    std::optional<float> longStart{std::nullopt};
+    std::optional<float> latEnd{std::nullopt};
+    std::optional<float> longEnd{std::nullopt};
+
+    size_t roadCount{0};
+    size_t connectionCount{0};
     std::vector<Road> roads;
-    std::vector<RoadPiece> roadPieces;
+    std::vector<unsigned int> connections;
+    /**
+     * Maps the road index inside the file to the index inside roads, SKIPPED_ROAD for skipped roads.
+     **/
+    static constexpr unsigned int SKIPPED_ROAD = std::numeric_limits<unsigned int>::max();
+    std::vector<unsigned int> newRoadIndices;
+
+    static Key to_key(const std::string& key) {
+        static const std::unordered_map<std::string, Key> KEYS{
+            {"maxDistLat", Key::MAX_DIST_LAT},
+            {"maxDistLong", Key::MAX_DIST_LONG},
+            {"roads", Key::ROADS},
+            {"connectionRoadIndexList", Key::CONNECTION_ROAD_INDEX_LIST},
+            {"start", Key::START},
+            {"end", Key::END},
+            {"connIndexStart", Key::CONN_INDEX_START},
+            {"connCountStart", Key::CONN_COUNT_START},
+            {"connIndexEnd", Key::CONN_INDEX_END},
+            {"connCountEnd", Key::CONN_COUNT_END},
+            {"distLat", Key::DIST_LAT},
+            {"distLong", Key::DIST_LONG}};
+        auto iter = KEYS.find(key);
+        return iter == KEYS.end() ? Key::UNKNOWN : iter->second;
+    }
 
-    if (!json.contains("roads")) {
-        throw std::runtime_error("Failed to parse map. 'roads' field missing.");
+    [[nodiscard]] bool in_roads() const {
+        return depth >= DEPTH_ROAD && rootKey == Key::ROADS;
     }
-    nlohmann::json::array_t roadsArray;
-    json.at("roads").get_to(roadsArray);
-    for (const nlohmann::json& jRoad : roadsArray) {
-        if (!jRoad.contains("connIndexStart")) {
-            throw std::runtime_error("Failed to parse map. 'connIndexStart' field missing.");
+
+    template <typename T>
+    static T require(const std::optional<T>& value, const char* name) {
+        if (!value) {
+            throw std::runtime_error(std::string("Failed to parse map. '") + name + "' field missing.");
         }
-        unsigned int connIndexStart = 0;
-        jRoad.at("connIndexStart").get_to(connIndexStart);
+        return *value;
+    }
 
-        if (!jRoad.contains("connCountStart")) {
-            throw std::runtime_error("Failed to parse map. 'connCountStart' field missing.");
+    void on_number(double value) {
+        if (depth == DEPTH_ROOT) {
+            if (rootKey == Key::MAX_DIST_LAT) {
+                width = static_cast<float>(value);
+            } else if (rootKey == Key::MAX_DIST_LONG) {
+                height = static_cast<float>(value);
+            }
+        } else if (depth == DEPTH_ROOT + 1 && rootKey == Key::CONNECTION_ROAD_INDEX_LIST) {
+            if (value < 0) {
+                throw std::runtime_error("Failed to parse map. Negative connection road index.");
+            }
+            connectionCount++;
+            if (mode == Mode::FILL) {
+                connections.push_back(static_cast<unsigned int>(value));
+            }
+        } else if (mode == Mode::FILL && in_roads()) {
+            on_road_number(value);
         }
-        unsigned int connCountStart = 0;
-        jRoad.at("connCountStart").get_to(connCountStart);
+    }
 
-        if (!jRoad.contains("start")) {
-            throw std::runtime_error("Failed to parse map. 'start' field missing.");
+    void on_road_number(double value) {
+        if (depth == DEPTH_ROAD) {
+            switch (roadKey) {
+                case Key::CONN_INDEX_START:
+                    connIndexStart = static_cast<unsigned int>(value);
+                    break;
+                case Key::CONN_COUNT_START:
+                    connCountStart = static_cast<unsigned int>(value);
+                    break;
+                case Key::CONN_INDEX_END:
+                    connIndexEnd = static_cast<unsigned int>(value);
+                    break;
+                case Key::CONN_COUNT_END:
+                    connCountEnd = static_cast<unsigned int>(value);
+                    break;
+                default:
+                    break;
+            }
+        } else if (depth == DEPTH_COORDINATE && (roadKey == Key::START || roadKey == Key::END)) {
+            const bool start = roadKey == Key::START;
+            if (coordinateKey == Key::DIST_LAT) {
+                (start ? latStart : latEnd) = static_cast<float>(value);
+            } else if (coordinateKey == Key::DIST_LONG) {
+                (start ? longStart : longEnd) = static_cast<float>(value);
+            }
         }
-        nlohmann::json jStart = jRoad["start"];
+    }
 
-        if (!jStart.contains("distLat")) {
-            throw std::runtime_error("Failed to parse map. 'distLat' field missing.");
+    void begin_road() {
+        connIndexStart = std::nullopt;
+        connCountStart = std::nullopt;
+        connIndexEnd = std::nullopt;
+        connCountEnd = std::nullopt;
+        latStart = std::nullopt;
+        longStart = std::nullopt;
+        latEnd = std::nullopt;
+        longEnd = std::nullopt;
+    }
+
+    void end_road() {
+        roadCount++;
+        if (mode == Mode::COUNT) {
+            return;
         }
-        float latStart = 0;
-        jStart.at("distLat").get_to(latStart);
 
-        if (!jStart.contains("distLong")) {
-            throw std::runtime_error("Failed to parse map. 'distLong' field missing.");
+        Vec2 start{require(latStart, "distLat"), require(longStart, "distLong")};
+        Vec2 end{require(latEnd, "distLat"), require(longEnd, "distLong")};
+        Coordinate startCoord{start, require(connIndexStart, "connIndexStart"), require(connCountStart, "connCountStart")};
+        Coordinate endCoord{end, require(connIndexEnd, "connIndexEnd"), require(connCountEnd, "connCountEnd")};
+
+        // Ensure we don't have any zero long edges (points):
+        if (start.x == end.x && start.y == end.y) {
+            SPDLOG_WARN("Zero length road detected. Skipping...");
+            newRoadIndices.push_back(SKIPPED_ROAD);
+            return;
         }
-        float longStart = 0;
-        jStart.at("distLong").get_to(longStart);
+        newRoadIndices.push_back(static_cast<unsigned int>(roads.size()));
+        roads.emplace_back(Road{startCoord, endCoord});
+    }
 
-        if (!jRoad.contains("connIndexEnd")) {
-            throw std::runtime_error("Failed to parse map. 'connIndexEnd' field missing.");
+    /**
+     * Rewrites the connection range of the given coordinate into newConnections, dropping all connections to skipped roads.
+     **/
+    void remap_connections(Coordinate& coord, std::vector<unsigned int>& newConnections) const {
+        const size_t start = newConnections.size();
+        const size_t end = static_cast<size_t>(coord.connectedIndex) + coord.connectedCount;
+        if (end > connections.size()) {
+            throw std::runtime_error("Failed to parse map. Road connections out of bounds.");
+        }
+        for (size_t i = coord.connectedIndex; i < end; i++) {
+            if (connections[i] >= newRoadIndices.size()) {
+                throw std::runtime_error("Failed to parse map. Connection to an unknown road.");
+            }
+            if (newRoadIndices[connections[i]] != SKIPPED_ROAD) {
+                newConnections.push_back(newRoadIndices[connections[i]]);
+            }
         }
-        unsigned int connIndexEnd = 0;
-        jRoad.at("connIndexEnd").get_to(connIndexEnd);
+        coord.connectedIndex = static_cast<unsigned int>(start);
+        coord.connectedCount = static_cast<unsigned int>(newConnections.size() - start);
+    }
+
+ public:
+    explicit MapSaxParser(Mode mode) : mode(mode) {}
+
+    void reserve(size_t expectedRoadCount, size_t expectedConnectionCount) {
+        roads.reserve(expectedRoadCount);
+        connections.reserve(expectedConnectionCount);
+        newRoadIndices.reserve(expectedRoadCount);
+    }
 
-        if (!jRoad.contains("connCountEnd")) {
-            throw std::runtime_error("Failed to parse map. 'connCountEnd' field missing.");
+    /**
+     * Connections reference roads by their index inside the file.
+     * In case zero length roads got skipped, those indices got shifted, so all connections get rewritten to the new indices.
+     **/
+    void remove_skipped_roads() {
+        if (roads.size() == newRoadIndices.size()) {
+            return;
+        }
+        SPDLOG_INFO("Remapping connections after skipping {} zero length roads...", newRoadIndices.size() - roads.size());
+        std::vector<unsigned int> newConnections;
+        newConnections.reserve(connections.size());
+        for (Road& road : roads) {
+            remap_connections(road.start, newConnections);
+            remap_connections(road.end, newConnections);
         }
-        unsigned int connCountEnd = 0;
-        jRoad.at("connCountEnd").get_to(connCountEnd);
+        connections = std::move(newConnections);
+    }
 
-        if (!jRoad.contains("end")) {
-            throw std::runtime_error("Failed to parse map. 'end' field missing.");
+    /**
+     * Throws a std::runtime_error in case a required field of the root object is missing.
+     **/
+    void validate() const {
+        require(width, "maxDistLat");
+        require(height, "maxDistLong");
+        if (!roadsFound) {
+            throw std::runtime_error("Failed to parse map. 'roads' field missing.");
+        }
+        if (!connectionsFound) {
+            throw std::runtime_error("Failed to parse map. 'connectionRoadIndexList' field missing.");
         }
-        nlohmann::json jEnd = jRoad["end"];
+    }
+
+    [[nodiscard]] float get_width() const {
+        return width.value_or(0);
+    }
+
+    [[nodiscard]] float get_height() const {
+        return height.value_or(0);
+    }
+
+    [[nodiscard]] size_t get_road_count() const {
+        return roadCount;
+    }
+
+    [[nodiscard]] size_t get_connection_count() const {
+        return connectionCount;
+    }
+
+    std::vector<Road> take_roads() {
+        return std::move(roads);
+    }
 
-        if (!jEnd.contains("distLat")) {
-            throw std::runtime_error("Failed to parse map. 'distLat' field missing.");
+    std::vector<unsigned int> take_connections() {
+        return std::move(connections);
+    }
+
+    bool null() override {
+        return true;
+    }
+
+    bool boolean(bool /*val*/) override {
+        return true;
+    }
+
+    bool number_integer(number_integer_t val) override {
+        on_number(static_cast<double>(val));
+        return true;
+    }
+
+    bool number_unsigned(number_unsigned_t val) override {
+        on_number(static_cast<double>(val));
+        return true;
+    }
+
+    bool number_float(number_float_t val, const string_t& /*s*/) override {
+        on_number(val);
+        return true;
+    }
+
+    bool string(string_t& /*val*/) override {
+        return true;
+    }
+
+    bool binary(binary_t& /*val*/) override {
+        return true;
+    }
+
+    bool start_object(size_t /*elements*/) override {
+        depth++;
+        if (depth == DEPTH_ROAD && rootKey == Key::ROADS) {
+            begin_road();
         }
-        float latEnd = 0;
-        jEnd.at("distLat").get_to(latEnd);
+        return true;
+    }
 
-        if (!jEnd.contains("distLong")) {
-            throw std::runtime_error("Failed to parse map. 'distLong' field missing.");
+    bool key(string_t& val) override {
+        if (depth == DEPTH_ROOT) {
+            rootKey = to_key(val);
+        } else if (in_roads()) {
+            (depth == DEPTH_ROAD ? roadKey : coordinateKey) = to_key(val);
         }
-        float longEnd = 0;
-        jEnd.at("distLong").get_to(longEnd);
+        return true;
+    }
 
-        Vec2 start{latStart, longStart};
-        Vec2 end{latEnd, longEnd};
+    bool end_object() override {
+        if (depth == DEPTH_ROAD && rootKey == Key::ROADS) {
+            end_road();
+        }
+        depth--;
+        return true;
+    }
 
-        // Ensure we don't have any zero long edges (points):
-        if (start.x == end.x && start.y == end.y) {
-            SPDLOG_WARN("Zero length road detected. Skipping...");
-            continue;
+    bool start_array(size_t /*elements*/) override {
+        depth++;
+        if (depth == DEPTH_ROOT + 1) {
+            roadsFound |= rootKey == Key::ROADS;
+            connectionsFound |= rootKey == Key::CONNECTION_ROAD_INDEX_LIST;
         }
+        return true;
+    }
 
-        roads.emplace_back(Road{Coordinate{start, connIndexStart, connCountStart}, Coordinate{end, connIndexEnd, connCountEnd}});
-        roadPieces.emplace_back(RoadPiece{start, {}, sim::Rgba{1.0, 0.0, 0.0, 1.0}});  // Start
-        roadPieces.emplace_back(RoadPiece{end, {}, sim::Rgba{1.0, 0.0, 0.0, 1.0}});  // End
+    bool end_array() override {
+        depth--;
+        return true;
     }
 
-    std::vector<unsigned int> connections{};
-    if (!json.contains("connectionRoadIndexList")) {
-        throw std::runtime_error("Failed to parse map. 'connectionRoadIndexList' field missing.");
+    bool parse_error(size_t position, const std::string& /*lastToken*/, const nlohmann::detail::exception& ex) override {
+        throw std::runtime_error("Failed to parse map at byte " + std::to_string(position) + ". " + ex.what());
     }
-    nlohmann::json::array_t connectionsArray;
-    json.at("connectionRoadIndexList").get_to(connectionsArray);
-    connections.reserve(connectionsArray.size());
-    for (const nlohmann::json& jConnection : connectionsArray) {
-        assert(jConnection.is_number_unsigned());
-        connections.push_back(static_cast<unsigned int>(jConnection));
+};
+}  // namespace
+
+std::shared_ptr<Map> Map::load_from_file(const std::filesystem::path& path) {
+    if (map_binary::is_binary_map_path(path)) {
+        return load_from_binary_file(path);
     }
+    return load_from_json_file(path);
+}
 
-    SPDLOG_INFO("Map loaded from '{}'. Found {} roads with {} connections.", path.string(), roads.size(), connections.size());
-    assert(roads.size() * 2 == roadPieces.size());
-    return std::make_shared<Map>(width, height, std::move(roads), std::move(roadPieces), std::move(connections));
+std::shared_ptr<Map> Map::load_from_binary_file(const std::filesystem::path& path) {
+    SPDLOG_INFO("Loading binary map from '{}'...", path.string());
+    if (!std::filesystem::exists(path)) {
+        SPDLOG_ERROR("Failed to open map from '{}'. File does not exist.", path.string());
+        return nullptr;
+    }
+
+    std::optional<map_binary::Contents> contents = map_binary::read(path);
+    if (!contents) {
+        return nullptr;
+    }
+
+    SPDLOG_INFO("Binary map loaded from '{}'. Found {} roads with {} connections.", path.string(), contents->roads.size(), contents->connections.size());
+    return std::make_shared<Map>(contents->width, contents->height, std::move(contents->roads), std::move(contents->connections));
 }
 
-unsigned int Map::get_random_road_index() const {
-    static std::random_device device;
-    static std::mt19937 gen(device());
-    static std::uniform_int_distribution<unsigned int> distr(0, roads.size() - 1);
-    return distr(gen);
+bool Map::save_to_binary_file(const std::filesystem::path& path) const {
+    std::vector<Road> roadsById = roads;
+    std::vector<unsigned int> connectionsById = connections;
+    reorder_roads(roadIdIndices, roadsById, connectionsById);
+    return map_binary::write(width, height, roadsById, connectionsById, path);
+}
+
+std::shared_ptr<Map> Map::load_from_json_file(const std::filesystem::path& path) {
+    SPDLOG_INFO("Loading map from '{}'...", path.string());
+    if (!std::filesystem::exists(path)) {
+        SPDLOG_ERROR("Failed to open map from '{}'. File does not exist.", path.string());
+        return nullptr;
+    }
+
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        SPDLOG_ERROR("Failed to open map from '{}'.", path.string());
+        return nullptr;
+    }
+
+    // First pass: Only count roads and connections, so the second pass can fill preallocated vectors:
+    MapSaxParser counter(MapSaxParser::Mode::COUNT);
+    nlohmann::json::sax_parse(file, &counter);
+
+    file.clear();
+    file.seekg(0);
+    MapSaxParser parser(MapSaxParser::Mode::FILL);
+    parser.reserve(counter.get_road_count(), counter.get_connection_count());
+    nlohmann::json::sax_parse(file, &parser);
+    parser.validate();
+    parser.remove_skipped_roads();
+
+    std::vector<Road> roads = parser.take_roads();
+    std::vector<unsigned int> connections = parser.take_connections();
+    SPDLOG_INFO("Map loaded from '{}'. Found {} roads with {} connections.", path.string(), roads.size(), connections.size());
+    return std::make_shared<Map>(parser.get_width(), parser.get_height(), std::move(roads), std::move(connections));
 }
 
 void Map::select_road(size_t roadIndex) {
     assert(roadIndex < roads.size());
+    selectedRoad = roadIndex;
+    selectionGeneration++;
+}
 
-    const sim::Rgba UNSELECTED_COLOR{1.0, 0.0, 0.0, 1.0};
-    const sim::Rgba SELECTED_COLOR{0.0, 1.0, 0.0, 1.0};
+std::optional<RoadHit> Map::nearest_road(const Vec2& pos) const {
+    return roadIndex.nearest(roads, pos);
+}
 
-    // Unselect selected road:
-    if (selectedRoad != std::nullopt) {
-        roadPieces[(*selectedRoad) * 2].color = UNSELECTED_COLOR;
-        roadPieces[((*selectedRoad) * 2) + 1].color = UNSELECTED_COLOR;
-    }
+std::vector<RoadHit> Map::nearest_roads(const Vec2& pos, size_t k) const {
+    return roadIndex.k_nearest(roads, pos, k);
+}
 
-    // Select new road:
-    selectedRoad = roadIndex;
-    roadPieces[(*selectedRoad) * 2].color = SELECTED_COLOR;
-    roadPieces[((*selectedRoad) * 2) + 1].color = SELECTED_COLOR;
+std::vector<size_t> Map::roads_in_rect(const Vec2& min, const Vec2& max) const {
+    return roadIndex.query_rect(roads, min, max);
 }
 }  // namespace sim
\ No newline at end of file
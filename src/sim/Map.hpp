@@ -1,7 +1,9 @@
 #pragma once
 
 #include "Entity.hpp"
+#include "RoadIndex.hpp"
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <memory>
 #include <optional>
@@ -24,26 +26,55 @@ struct Road {
 
 } __attribute__((aligned(32))) __attribute__((__packed__));
 
-struct RoadPiece {
-    Vec2 pos;
-    Vec2 padding;
-    sim::Rgba color;
-} __attribute__((aligned(32))) __attribute__((__packed__));
-
 class Map {
  public:
     float width;
     float height;
+    /**
+     * Roads sorted along a Hilbert curve over their midpoints, so roads close to each other are also close in memory.
+     **/
     std::vector<Road> roads;
-    std::vector<RoadPiece> roadPieces;
+    /**
+     * Connected road indices. Stored in the same order as the roads they belong to.
+     **/
     std::vector<unsigned int> connections;
+    /**
+     * Stable external road IDs (the road index inside the map file) since roads get renumbered on load.
+     * roadIds[i] is the ID of roads[i] and roadIdIndices[id] the index of the road with the given ID.
+     **/
+    std::vector<uint32_t> roadIds;
+    std::vector<uint32_t> roadIdIndices;
+    /**
+     * Spatial index over all roads. Has to be rebuilt in case roads change.
+     **/
+    RoadIndex roadIndex;
     std::optional<size_t> selectedRoad{std::nullopt};
+    /**
+     * Incremented every time the selection changes, so views can tell whether they have to redraw it.
+     **/
+    uint64_t selectionGeneration{0};
 
-    Map(float width, float height, std::vector<Road>&& roads, std::vector<RoadPiece>&& roadPieces, std::vector<unsigned int>&& connections);
+    Map(float width, float height, std::vector<Road>&& roads, std::vector<unsigned int>&& connections);
 
+    /**
+     * Loads the map from the binary map format in case the path ends with map_binary::FILE_EXTENSION.
+     * Else the map gets parsed from JSON.
+     **/
     static std::shared_ptr<Map> load_from_file(const std::filesystem::path& path);
+    static std::shared_ptr<Map> load_from_json_file(const std::filesystem::path& path);
+    static std::shared_ptr<Map> load_from_binary_file(const std::filesystem::path& path);
+    /**
+     * Writes the roads in the order of their IDs, so loading the file again results in the same IDs.
+     **/
+    [[nodiscard]] bool save_to_binary_file(const std::filesystem::path& path) const;
 
-    [[nodiscard]] unsigned int get_random_road_index() const;
+    /**
+     * Only stores the selection. The highlight gets resolved by the map shader.
+     **/
     void select_road(size_t roadIndex);
+
+    [[nodiscard]] std::optional<RoadHit> nearest_road(const Vec2& pos) const;
+    [[nodiscard]] std::vector<RoadHit> nearest_roads(const Vec2& pos, size_t k) const;
+    [[nodiscard]] std::vector<size_t> roads_in_rect(const Vec2& min, const Vec2& max) const;
 };
 }  // namespace sim
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include "MapBinary.hpp"
+#include "logger/Logger.hpp"
+#include "spdlog/spdlog.h"
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sim::map_binary {
+namespace {
+static_assert(sizeof(unsigned int) == sizeof(uint32_t), "Connections are stored as 32 bit unsigned integers.");
+
+constexpr uint64_t align_up(uint64_t value, uint64_t alignment) {
+    return ((value + alignment - 1) / alignment) * alignment;
+}
+
+/**
+ * Read only memory mapping of a whole file that gets unmapped once it goes out of scope.
+ **/
+class MappedFile {
+ private:
+    int fd{-1};
+    void* data{MAP_FAILED};
+    size_t size{0};
+
+ public:
+    explicit MappedFile(const std::filesystem::path& path) : fd(open(path.c_str(), O_RDONLY | O_CLOEXEC)) {  // NOLINT (cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+        if (fd < 0) {
+            return;
+        }
+
+        struct stat fileStat {};
+        if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0) {
+            return;
+        }
+        size = static_cast<size_t>(fileStat.st_size);
+        data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            // The whole file gets copied out sequentially:
+            madvise(data, size, MADV_SEQUENTIAL);
+        }
+    }
+    MappedFile(MappedFile& other) = delete;
+    MappedFile(MappedFile&& old) = delete;
+
+    ~MappedFile() {
+        if (data != MAP_FAILED) {
+            munmap(data, size);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    MappedFile& operator=(MappedFile& other) = delete;
+    MappedFile& operator=(MappedFile&& old) = delete;
+
+    [[nodiscard]] bool is_valid() const {
+        return data != MAP_FAILED;
+    }
+
+    [[nodiscard]] const std::byte* get_data() const {
+        return static_cast<const std::byte*>(data);
+    }
+
+    [[nodiscard]] size_t get_size() const {
+        return size;
+    }
+};
+
+/**
+ * Returns true in case [offset, offset + count * elemSize) lies within a file of the given size.
+ **/
+bool is_in_bounds(uint64_t offset, uint64_t count, uint64_t elemSize, uint64_t fileSize) {
+    if (offset > fileSize || count > (std::numeric_limits<uint64_t>::max() / elemSize)) {
+        return false;
+    }
+    return count * elemSize <= fileSize - offset;
+}
+
+/**
+ * Returns true in case the connection range of the coordinate lies within the connections and all connections in it reference existing roads.
+ **/
+bool is_valid_coordinate(const Coordinate& coord, const std::vector<Road>& roads, const std::vector<unsigned int>& connections) {
+    const uint64_t end = static_cast<uint64_t>(coord.connectedIndex) + coord.connectedCount;
+    if (end > connections.size()) {
+        return false;
+    }
+    for (uint64_t i = coord.connectedIndex; i < end; i++) {
+        if (connections[i] >= roads.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+}  // namespace
+
+bool write(float width, float height, const std::vector<Road>& roads, const std::vector<unsigned int>& connections, const std::filesystem::path& path) {
+    SPDLOG_INFO("Writing binary map to '{}'...", path.string());
+
+    Header header{};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.headerSize = sizeof(Header);
+    header.width = width;
+    header.height = height;
+    header.roadCount = roads.size();
+    header.roadOffset = align_up(sizeof(Header), alignof(Road));
+    header.connectionCount = connections.size();
+    header.connectionOffset = align_up(header.roadOffset + (header.roadCount * sizeof(Road)), alignof(uint32_t));
+    header.fileSize = header.connectionOffset + (header.connectionCount * sizeof(uint32_t));
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        SPDLOG_ERROR("Failed to open '{}' for writing.", path.string());
+        return false;
+    }
+
+    // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    const std::vector<char> padding(header.roadOffset - sizeof(Header), 0);
+    file.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+    file.write(reinterpret_cast<const char*>(roads.data()), static_cast<std::streamsize>(roads.size() * sizeof(Road)));
+    file.write(reinterpret_cast<const char*>(connections.data()), static_cast<std::streamsize>(connections.size() * sizeof(uint32_t)));
+    // NOLINTEND (cppcoreguidelines-pro-type-reinterpret-cast)
+    file.close();
+
+    if (!file) {
+        SPDLOG_ERROR("Failed to write binary map to '{}'.", path.string());
+        return false;
+    }
+    SPDLOG_INFO("Binary map written to '{}'. {} roads with {} connections ({} bytes).", path.string(), roads.size(), connections.size(), static_cast<uint64_t>(header.fileSize));
+    return true;
+}
+
+std::optional<Contents> read(const std::filesystem::path& path) {
+    const MappedFile file(path);
+    if (!file.is_valid()) {
+        SPDLOG_ERROR("Failed to memory map binary map from '{}'.", path.string());
+        return std::nullopt;
+    }
+
+    if (file.get_size() < sizeof(Header)) {
+        throw std::runtime_error("Failed to parse binary map. File too small for the header.");
+    }
+    Header header{};
+    std::memcpy(&header, file.get_data(), sizeof(Header));
+
+    if (header.magic != MAGIC) {
+        throw std::runtime_error("Failed to parse binary map. Invalid magic.");
+    }
+    if (header.version != VERSION) {
+        throw std::runtime_error("Failed to parse binary map. Unsupported version " + std::to_string(header.version) + ", expected " + std::to_string(VERSION) + ". Convert the map again.");
+    }
+    if (header.headerSize != sizeof(Header) || header.fileSize != file.get_size()) {
+        throw std::runtime_error("Failed to parse binary map. Header and file size do not match.");
+    }
+    if (header.roadOffset % alignof(Road) != 0 || !is_in_bounds(header.roadOffset, header.roadCount, sizeof(Road), header.fileSize)) {
+        throw std::runtime_error("Failed to parse binary map. Invalid road table.");
+    }
+    if (header.connectionOffset % alignof(uint32_t) != 0 || !is_in_bounds(header.connectionOffset, header.connectionCount, sizeof(uint32_t), header.fileSize)) {
+        throw std::runtime_error("Failed to parse binary map. Invalid connection table.");
+    }
+
+    // Both tables are stored in their in memory layout, so they get copied in one go without per element parsing:
+    Contents contents;
+    contents.width = header.width;
+    contents.height = header.height;
+    contents.roads.resize(header.roadCount);
+    std::memcpy(contents.roads.data(), file.get_data() + header.roadOffset, header.roadCount * sizeof(Road));  // NOLINT (cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    contents.connections.resize(header.connectionCount);
+    std::memcpy(contents.connections.data(), file.get_data() + header.connectionOffset, header.connectionCount * sizeof(uint32_t));  // NOLINT (cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+    // Corrupt connections would make the map and the simulation index out of bounds later on:
+    for (const Road& road : contents.roads) {
+        if (!is_valid_coordinate(road.start, contents.roads, contents.connections) || !is_valid_coordinate(road.end, contents.roads, contents.connections)) {
+            throw std::runtime_error("Failed to parse binary map. Road connections out of bounds.");
+        }
+    }
+    return contents;
+}
+
+bool is_binary_map_path(const std::filesystem::path& path) {
+    return path.extension() == FILE_EXTENSION;
+}
+}  // namespace sim::map_binary
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Map.hpp"
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+/**
+ * Versioned binary map format that can be memory mapped and copied straight into the road and connection arrays.
+ * All values are stored in native (little endian) byte order.
+ *
+ * Layout:
+ * [Header][Padding][Road table (roadCount * sizeof(Road))][Connection table (connectionCount * sizeof(uint32_t))]
+ **/
+namespace sim::map_binary {
+static_assert(std::endian::native == std::endian::little, "The binary map format requires a little endian host.");
+
+constexpr std::array<char, 8> MAGIC{'M', 'S', 'I', 'M', 'M', 'A', 'P', '\0'};
+/**
+ * Has to be incremented every time the layout of the Header, Road or Coordinate changes.
+ **/
+constexpr uint32_t VERSION = 1;
+constexpr const char* FILE_EXTENSION = ".msim";
+
+struct Header {
+    std::array<char, 8> magic{};
+    uint32_t version{0};
+    uint32_t headerSize{0};
+
+    // Bounds:
+    float width{0};
+    float height{0};
+
+    uint64_t roadCount{0};
+    /**
+     * Offset in bytes from the start of the file. Aligned to alignof(Road).
+     **/
+    uint64_t roadOffset{0};
+    uint64_t connectionCount{0};
+    /**
+     * Offset in bytes from the start of the file. Aligned to alignof(uint32_t).
+     **/
+    uint64_t connectionOffset{0};
+    uint64_t fileSize{0};
+} __attribute__((aligned(8))) __attribute__((__packed__));
+static_assert(sizeof(Header) == 64, "Binary map header size changed. Increment VERSION.");
+static_assert(sizeof(Road) == 32, "Road size changed. Increment VERSION.");
+
+struct Contents {
+    float width{0};
+    float height{0};
+    std::vector<Road> roads;
+    std::vector<unsigned int> connections;
+};
+
+/**
+ * Writes the given roads and connections to the given path.
+ * Returns false in case writing failed.
+ **/
+bool write(float width, float height, const std::vector<Road>& roads, const std::vector<unsigned int>& connections, const std::filesystem::path& path);
+
+/**
+ * Memory maps the given file and copies the road and connection tables out of it.
+ * Returns std::nullopt in case the file could not be opened.
+ * Throws a std::runtime_error in case the file is not a valid binary map.
+ **/
+std::optional<Contents> read(const std::filesystem::path& path);
+
+bool is_binary_map_path(const std::filesystem::path& path);
+}  // namespace sim::map_binary
@@ -0,0 +1,14 @@
+#include "OpComputeBarrier.hpp"
+
+namespace sim {
+void OpComputeBarrier::record(const vk::CommandBuffer& commandBuffer) {
+    // A single global barrier instead of one per buffer, since the dispatches of a pass share most of their buffers.
+    // Also covers write after read, e.g. a pass overwriting a scratch buffer the previous one read from:
+    const vk::MemoryBarrier barrier{vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite};
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, {}, barrier, nullptr, nullptr);
+}
+
+void OpComputeBarrier::preEval(const vk::CommandBuffer& /*commandBuffer*/) {}
+
+void OpComputeBarrier::postEval(const vk::CommandBuffer& /*commandBuffer*/) {}
+}  // namespace sim
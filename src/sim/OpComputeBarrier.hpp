@@ -0,0 +1,25 @@
+#pragma once
+
+#include <kompute/operations/OpBase.hpp>
+
+namespace sim {
+/**
+ * Makes all shader writes of the previously recorded dispatches visible to the dispatches recorded afterwards.
+ * kp::OpAlgoDispatch only waits for transfers, so it has to be recorded between every two dependent dispatches of a sequence.
+ **/
+class OpComputeBarrier : public kp::OpBase {
+ public:
+    OpComputeBarrier() = default;
+    OpComputeBarrier(OpComputeBarrier& other) = delete;
+    OpComputeBarrier(OpComputeBarrier&& old) = delete;
+
+    ~OpComputeBarrier() override = default;
+
+    OpComputeBarrier& operator=(OpComputeBarrier& other) = delete;
+    OpComputeBarrier& operator=(OpComputeBarrier&& old) = delete;
+
+    void record(const vk::CommandBuffer& commandBuffer) override;
+    void preEval(const vk::CommandBuffer& commandBuffer) override;
+    void postEval(const vk::CommandBuffer& commandBuffer) override;
+};
+}  // namespace sim
@@ -5,6 +5,14 @@
 #include <cstdint>
 
 namespace sim {
+/**
+ * Passes of random_move.comp selected via PushConsts::pass.
+ **/
+enum class MovePass : uint32_t {
+    MOVE = 0,
+    COLLISION = 1
+};
+
 // NOLINTNEXTLINE (altera-struct-pack-align) Ignore alignment since we need a compact layout.
 struct PushConsts {
     float worldSizeX{0};
@@ -17,5 +25,28 @@ struct PushConsts {
     float collisionRadius{0};
 
     uint32_t tick{0};
+
+    uint32_t collisionBackend{0};
+    uint32_t roadCount{0};
+    uint32_t pass{0};
+
+    /**
+     * Simulated seconds per integration step.
+     **/
+    float dt{1};
+    /**
+     * Integration steps the move pass advances per dispatch.
+     **/
+    uint32_t substeps{1};
+
+    /**
+     * Key for the counter-based random number generator used by init_entities.comp and random_move.comp.
+     **/
+    uint32_t seed{0};
+
+    /**
+     * Radix sort step or attribute index for the passes of reorder.comp.
+     **/
+    uint32_t reorderStep{0};
 } __attribute__((packed)) __attribute__((aligned(4)));
 }  // namespace sim
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include "RoadIndex.hpp"
+#include "Map.hpp"
+#include "logger/Logger.hpp"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <unordered_set>
+
+namespace sim {
+namespace {
+/**
+ * The grid cell size relative to the average road length or the side length of the average area per road, whichever is larger.
+ * Larger cells result in less cells per road but more candidates per cell.
+ **/
+constexpr float GRID_CELL_SIZE_FACTOR = 2;
+
+/**
+ * Liang-Barsky line clipping against the rectangle [min, max].
+ **/
+bool segment_intersects_rect(const Vec2& a, const Vec2& b, const Vec2& min, const Vec2& max) {
+    float t0 = 0;
+    float t1 = 1;
+    const float dx = b.x - a.x;
+    const float dy = b.y - a.y;
+    const std::array<float, 4> p{-dx, dx, -dy, dy};
+    const std::array<float, 4> q{a.x - min.x, max.x - a.x, a.y - min.y, max.y - a.y};
+    for (size_t i = 0; i < p.size(); i++) {
+        if (p[i] == 0) {
+            // Parallel to this edge:
+            if (q[i] < 0) {
+                return false;
+            }
+            continue;
+        }
+        const float t = q[i] / p[i];
+        if (p[i] < 0) {
+            t0 = std::max(t0, t);
+        } else {
+            t1 = std::min(t1, t);
+        }
+        if (t0 > t1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool compare_hits(const RoadHit& a, const RoadHit& b) {
+    return a.distance < b.distance || (a.distance == b.distance && a.roadIndex < b.roadIndex);
+}
+}  // namespace
+
+float point_segment_distance(const Vec2& p, const Vec2& a, const Vec2& b) {
+    const float dx = b.x - a.x;
+    const float dy = b.y - a.y;
+    const float len2 = (dx * dx) + (dy * dy);
+    if (len2 <= 0) {
+        return std::hypot(p.x - a.x, p.y - a.y);
+    }
+    const float t = std::clamp((((p.x - a.x) * dx) + ((p.y - a.y) * dy)) / len2, 0.0F, 1.0F);
+    return std::hypot(p.x - (a.x + (t * dx)), p.y - (a.y + (t * dy)));
+}
+
+RoadIndex::RoadIndex(const std::vector<Road>& roads) {
+    if (roads.empty()) {
+        return;
+    }
+
+    Vec2 max{std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+    origin = Vec2{std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+    double totalLength = 0;
+    for (const Road& road : roads) {
+        origin.x = std::min({origin.x, road.start.pos.x, road.end.pos.x});
+        origin.y = std::min({origin.y, road.start.pos.y, road.end.pos.y});
+        max.x = std::max({max.x, road.start.pos.x, road.end.pos.x});
+        max.y = std::max({max.y, road.start.pos.y, road.end.pos.y});
+        totalLength += road.start.pos.dist(road.end.pos);
+    }
+
+    const float width = max.x - origin.x;
+    const float height = max.y - origin.y;
+    const auto roadCount = static_cast<float>(roads.size());
+    const float avgRoadLength = static_cast<float>(totalLength) / roadCount;
+    const float avgAreaSide = std::sqrt((width * height) / roadCount);
+    cellSize = std::max({avgRoadLength, avgAreaSide, std::numeric_limits<float>::min()}) * GRID_CELL_SIZE_FACTOR;
+    cellsX = std::max(static_cast<int64_t>(std::ceil(width / cellSize)), static_cast<int64_t>(1));
+    cellsY = std::max(static_cast<int64_t>(std::ceil(height / cellSize)), static_cast<int64_t>(1));
+
+    // Calls func(cellIndex) for every cell the bounding box of the given road overlaps:
+    auto forEachCell = [this](const Road& road, auto&& func) {
+        const int64_t minX = to_clamped_cell_x(std::min(road.start.pos.x, road.end.pos.x));
+        const int64_t maxX = to_clamped_cell_x(std::max(road.start.pos.x, road.end.pos.x));
+        const int64_t minY = to_clamped_cell_y(std::min(road.start.pos.y, road.end.pos.y));
+        const int64_t maxY = to_clamped_cell_y(std::max(road.start.pos.y, road.end.pos.y));
+        for (int64_t y = minY; y <= maxY; y++) {
+            for (int64_t x = minX; x <= maxX; x++) {
+                func(static_cast<size_t>((y * cellsX) + x));
+            }
+        }
+    };
+
+    // Count roads per cell:
+    cellStarts.resize(static_cast<size_t>(cellsX * cellsY) + 1, 0);
+    for (const Road& road : roads) {
+        forEachCell(road, [this](size_t cell) { cellStarts[cell + 1]++; });
+    }
+
+    // Prefix sum:
+    for (size_t i = 1; i < cellStarts.size(); i++) {
+        cellStarts[i] += cellStarts[i - 1];
+    }
+
+    // Fill:
+    cellRoads.resize(cellStarts.back());
+    std::vector<uint32_t> cellFill(cellStarts.begin(), cellStarts.end() - 1);
+    for (size_t i = 0; i < roads.size(); i++) {
+        forEachCell(roads[i], [this, &cellFill, i](size_t cell) { cellRoads[cellFill[cell]++] = static_cast<uint32_t>(i); });
+    }
+
+    SPDLOG_INFO("Road index built with {}x{} cells of {} meters and {} entries ({:.2f} per road).", cellsX, cellsY, cellSize, cellRoads.size(), static_cast<double>(cellRoads.size()) / static_cast<double>(roads.size()));
+}
+
+int64_t RoadIndex::to_cell(float v) const {
+    return static_cast<int64_t>(std::floor(v / cellSize));
+}
+
+int64_t RoadIndex::to_clamped_cell_x(float x) const {
+    return std::clamp(to_cell(x - origin.x), static_cast<int64_t>(0), cellsX - 1);
+}
+
+int64_t RoadIndex::to_clamped_cell_y(float y) const {
+    return std::clamp(to_cell(y - origin.y), static_cast<int64_t>(0), cellsY - 1);
+}
+
+template <typename Func>
+bool RoadIndex::for_each_road_in_ring(int64_t cx, int64_t cy, int64_t ring, Func&& func) const {
+    const int64_t maxRing = std::max({cx, cellsX - 1 - cx, cy, cellsY - 1 - cy});
+    if (ring > maxRing) {
+        return false;
+    }
+
+    auto visitCell = [this, &func](int64_t x, int64_t y) {
+        if (x < 0 || x >= cellsX || y < 0 || y >= cellsY) {
+            return;
+        }
+        const auto cell = static_cast<size_t>((y * cellsX) + x);
+        for (uint32_t i = cellStarts[cell]; i < cellStarts[cell + 1]; i++) {
+            func(static_cast<size_t>(cellRoads[i]));
+        }
+    };
+
+    if (ring == 0) {
+        visitCell(cx, cy);
+        return true;
+    }
+
+    // Top and bottom row:
+    for (int64_t x = cx - ring; x <= cx + ring; x++) {
+        visitCell(x, cy - ring);
+        visitCell(x, cy + ring);
+    }
+    // Left and right column without the corners:
+    for (int64_t y = cy - ring + 1; y <= cy + ring - 1; y++) {
+        visitCell(cx - ring, y);
+        visitCell(cx + ring, y);
+    }
+    return true;
+}
+
+std::optional<RoadHit> RoadIndex::nearest(const std::vector<Road>& roads, const Vec2& pos) const {
+    std::vector<RoadHit> hits = k_nearest(roads, pos, 1);
+    if (hits.empty()) {
+        return std::nullopt;
+    }
+    return hits.front();
+}
+
+std::vector<RoadHit> RoadIndex::k_nearest(const std::vector<Road>& roads, const Vec2& pos, size_t k) const {
+    std::vector<RoadHit> heap;
+    if (k == 0 || cellRoads.empty()) {
+        return heap;
+    }
+    heap.reserve(k);
+
+    const int64_t cx = to_cell(pos.x - origin.x);
+    const int64_t cy = to_cell(pos.y - origin.y);
+
+    // Roads span multiple cells, so make sure each one only gets added once:
+    std::unordered_set<size_t> visited;
+    for (int64_t ring = 0;; ring++) {
+        const bool inGrid = for_each_road_in_ring(cx, cy, ring, [&](size_t roadIndex) {
+            if (!visited.insert(roadIndex).second) {
+                return;
+            }
+            const Road& road = roads[roadIndex];
+            const RoadHit hit{roadIndex, point_segment_distance(pos, road.start.pos, road.end.pos)};
+            if (heap.size() < k) {
+                heap.push_back(hit);
+                std::push_heap(heap.begin(), heap.end(), compare_hits);
+            } else if (compare_hits(hit, heap.front())) {
+                std::pop_heap(heap.begin(), heap.end(), compare_hits);
+                heap.back() = hit;
+                std::push_heap(heap.begin(), heap.end(), compare_hits);
+            }
+        });
+
+        // All roads not visited yet are at least ring * cellSize away:
+        if (!inGrid || (heap.size() == k && heap.front().distance <= static_cast<float>(ring) * cellSize)) {
+            break;
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end(), compare_hits);
+    return heap;
+}
+
+std::vector<size_t> RoadIndex::query_rect(const std::vector<Road>& roads, const Vec2& min, const Vec2& max) const {
+    assert(min.x <= max.x && min.y <= max.y);
+    std::vector<size_t> result;
+    if (cellRoads.empty()) {
+        return result;
+    }
+
+    const int64_t minX = to_clamped_cell_x(min.x);
+    const int64_t maxX = to_clamped_cell_x(max.x);
+    const int64_t minY = to_clamped_cell_y(min.y);
+    const int64_t maxY = to_clamped_cell_y(max.y);
+    for (int64_t y = minY; y <= maxY; y++) {
+        for (int64_t x = minX; x <= maxX; x++) {
+            const auto cell = static_cast<size_t>((y * cellsX) + x);
+            for (uint32_t i = cellStarts[cell]; i < cellStarts[cell + 1]; i++) {
+                result.push_back(cellRoads[i]);
+            }
+        }
+    }
+
+    // Roads span multiple cells:
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    std::erase_if(result, [&](size_t roadIndex) { return !segment_intersects_rect(roads[roadIndex].start.pos, roads[roadIndex].end.pos, min, max); });
+    return result;
+}
+}  // namespace sim
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Entity.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace sim {
+struct Road;
+
+/**
+ * Returns the shortest distance between the point p and the line segment from a to b.
+ **/
+float point_segment_distance(const Vec2& p, const Vec2& a, const Vec2& b);
+
+struct RoadHit {
+    size_t roadIndex{0};
+    /**
+     * Shortest distance between the query position and the road segment.
+     **/
+    float distance{0};
+};
+
+/**
+ * Static uniform grid over all road segments, built once at load time.
+ * Each road gets registered in every cell its bounding box overlaps.
+ * Queries search outward from the cell of the query position ring by ring, so they only touch roads close to it.
+ *
+ * The index does not own the roads. All queries expect the same roads the index has been built from.
+ **/
+class RoadIndex {
+ private:
+    // Grid origin, the minimum of the bounding box over all roads:
+    Vec2 origin{};
+    float cellSize{1};
+    int64_t cellsX{0};
+    int64_t cellsY{0};
+
+    /**
+     * Roads per cell in the compressed sparse row format.
+     * The roads of cell i are cellRoads[cellStarts[i]] until cellRoads[cellStarts[i + 1]].
+     **/
+    std::vector<uint32_t> cellStarts;
+    std::vector<uint32_t> cellRoads;
+
+    /**
+     * Returns the (unclamped) cell coordinate of the given coordinate relative to the grid origin.
+     **/
+    [[nodiscard]] int64_t to_cell(float v) const;
+    [[nodiscard]] int64_t to_clamped_cell_x(float x) const;
+    [[nodiscard]] int64_t to_clamped_cell_y(float y) const;
+
+    /**
+     * Calls func(roadIndex) for every road registered in a cell with a Chebyshev distance of exactly ring cells to (cx, cy).
+     * Returns false in case the ring lies completely outside the grid.
+     **/
+    template <typename Func>
+    bool for_each_road_in_ring(int64_t cx, int64_t cy, int64_t ring, Func&& func) const;
+
+ public:
+    RoadIndex() = default;
+    explicit RoadIndex(const std::vector<Road>& roads);
+
+    /**
+     * Returns the road closest to pos, or std::nullopt in case there are no roads.
+     **/
+    [[nodiscard]] std::optional<RoadHit> nearest(const std::vector<Road>& roads, const Vec2& pos) const;
+
+    /**
+     * Returns up to k roads closest to pos, sorted by their distance in ascending order.
+     **/
+    [[nodiscard]] std::vector<RoadHit> k_nearest(const std::vector<Road>& roads, const Vec2& pos, size_t k) const;
+
+    /**
+     * Returns the indices of all roads that intersect the axis aligned rectangle [min, max], sorted in ascending order.
+     **/
+    [[nodiscard]] std::vector<size_t> query_rect(const std::vector<Road>& roads, const Vec2& min, const Vec2& max) const;
+};
+}  // namespace sim
@@ -1,12 +1,21 @@
 #include "Simulator.hpp"
 #include "fall.hpp"
+#include "init_entities.hpp"
 #include "kompute/Manager.hpp"
 #include "kompute/Tensor.hpp"
 #include "logger/Logger.hpp"
 #include "random_move.hpp"
+#include "reorder.hpp"
+#include "render_entities.hpp"
+#include "road_graph.hpp"
 #include "sim/Entity.hpp"
+#include "sim/GlInterop.hpp"
 #include "sim/GpuQuadTree.hpp"
+#include "sim/GpuReorder.hpp"
+#include "sim/GpuRoadGraph.hpp"
 #include "sim/Map.hpp"
+#include "sim/MapBinary.hpp"
+#include "sim/OpComputeBarrier.hpp"
 #include "sim/PushConsts.hpp"
 #include "spdlog/spdlog.h"
 #include "vulkan/vulkan_enums.hpp"
@@ -31,6 +40,16 @@
 #endif
 
 namespace sim {
+std::string_view to_string(CollisionBackend backend) {
+    switch (backend) {
+        case CollisionBackend::QUAD_TREE:
+            return "quad_tree";
+        case CollisionBackend::ROAD_GRAPH:
+            return "road_graph";
+    }
+    return "unknown";
+}
+
 Simulator::Simulator() {
     prepare_log_csv_file();
 }
@@ -49,16 +68,46 @@ void Simulator::init() {
     init_renderdoc();
 #endif
 
-    mgr = std::make_shared<kp::Manager>();
+    // Request the extensions required for sharing buffers with OpenGL. Kompute skips the ones the device does not support:
+    mgr = std::make_shared<kp::Manager>(0, std::vector<uint32_t>{}, std::vector<std::string>(gl_interop::REQUIRED_DEVICE_EXTENSIONS.begin(), gl_interop::REQUIRED_DEVICE_EXTENSIONS.end()));
 
     // Load map:
-    map = Map::load_from_file("/home/fabian/Documents/Repos/movement-sim/munich.json");
+    // Prefer the binary version of the map in case it has been converted via msim-mapconv:
+    std::filesystem::path mapPath = "/home/fabian/Documents/Repos/movement-sim/munich.json";
+    std::filesystem::path binaryMapPath = mapPath;
+    binaryMapPath.replace_extension(map_binary::FILE_EXTENSION);
+    map = Map::load_from_file(std::filesystem::exists(binaryMapPath) ? binaryMapPath : mapPath);
 
     shader = std::vector(RANDOM_MOVE_COMP_SPV.begin(), RANDOM_MOVE_COMP_SPV.end());
 
     // Entities:
-    add_entities();
-    tensorEntities = mgr->tensor(entities->data(), entities->size(), sizeof(Entity), kp::Tensor::TensorDataTypes::eUnsignedInt);
+    // Only allocated here. The actual entities get generated on the GPU by init_entities() at the end of init():
+    static_assert(sizeof(Vec2) == sizeof(float) * 2, "Entity position size does not match. Expected to be constructed out of 2 float.");
+    static_assert(sizeof(EntityMotion) == sizeof(float) * 4, "Entity motion size does not match. Expected to be constructed out of 4 float.");
+    static_assert(sizeof(RenderEntity) == sizeof(uint32_t) * 2, "Render entity size does not match. Expected to be constructed out of 2 uint32_t.");
+    std::vector<RenderEntity> renderEntities(MAX_ENTITIES);
+    std::vector<Vec2> entityPositions(MAX_ENTITIES);
+    std::vector<EntityMotion> entityMotions(MAX_ENTITIES);
+    std::vector<uint32_t> entityRoadIndices(MAX_ENTITIES, 0);
+    std::vector<uint32_t> entityCollisionBits((MAX_ENTITIES + 31) / 32, 0);
+    std::vector<uint32_t> entityStates(MAX_ENTITIES, 0);
+    std::vector<uint32_t> entityIds(MAX_ENTITIES, 0);
+    tensorEntityPositions = mgr->tensor(entityPositions.data(), entityPositions.size(), sizeof(Vec2), kp::Tensor::TensorDataTypes::eUnsignedInt);
+    tensorEntityMotions = mgr->tensor(entityMotions.data(), entityMotions.size(), sizeof(EntityMotion), kp::Tensor::TensorDataTypes::eUnsignedInt);
+    tensorEntityRoadIndices = mgr->tensor(entityRoadIndices.data(), entityRoadIndices.size(), sizeof(uint32_t), kp::Tensor::TensorDataTypes::eUnsignedInt);
+    tensorEntityCollisionBits = mgr->tensor(entityCollisionBits.data(), entityCollisionBits.size(), sizeof(uint32_t), kp::Tensor::TensorDataTypes::eUnsignedInt);
+    tensorEntityStates = mgr->tensor(entityStates.data(), entityStates.size(), sizeof(uint32_t), kp::Tensor::TensorDataTypes::eUnsignedInt);
+    tensorEntityIds = mgr->tensor(entityIds.data(), entityIds.size(), sizeof(uint32_t), kp::Tensor::TensorDataTypes::eUnsignedInt);
+    tensorEntitySlots = mgr->tensor(entityIds.data(), entityIds.size(), sizeof(uint32_t), kp::Tensor::TensorDataTypes::eUnsignedInt);
+    tensorRenderEntities = mgr->tensor(renderEntities.data(), renderEntities.size(), sizeof(RenderEntity), kp::Tensor::TensorDataTypes::eUnsignedInt);
+    sharedRenderEntities = gl_interop::SharedBuffer::create(*mgr, sizeof(RenderEntity) * MAX_ENTITIES);
+    if (sharedRenderEntities) {
+        sharedBufferSync = gl_interop::SharedBufferSync::create(*mgr);
+        if (!sharedBufferSync) {
+            SPDLOG_INFO("Vulkan OpenGL interop unavailable. Failed to create the semaphores for handing over shared buffers.");
+            sharedRenderEntities = nullptr;
+        }
+    }
 
     // Uniform data:
     tensorRoads = mgr->tensor(map->roads.data(), map->roads.size(), sizeof(Road), kp::Tensor::TensorDataTypes::eUnsignedInt);
@@ -75,11 +124,15 @@ void Simulator::init() {
     assert(gpu_quad_tree::calc_node_count(4) == 85);
     assert(gpu_quad_tree::calc_node_count(8) == 21845);
 
-    quadTreeNodes->resize(gpu_quad_tree::calc_node_count(QUAD_TREE_MAX_DEPTH));
-    gpu_quad_tree::init_node_zero((*quadTreeNodes)[0], map->width, map->height);
-    tensorQuadTreeNodes = mgr->tensor(quadTreeNodes->data(), quadTreeNodes->size(), sizeof(gpu_quad_tree::Node), kp::Tensor::TensorDataTypes::eUnsignedInt);
+    std::vector<gpu_quad_tree::Node> quadTreeNodes(gpu_quad_tree::calc_node_count(QUAD_TREE_MAX_DEPTH));
+    gpu_quad_tree::init_node_zero(quadTreeNodes[0], map->width, map->height);
+    tensorQuadTreeNodes = mgr->tensor(quadTreeNodes.data(), quadTreeNodes.size(), sizeof(gpu_quad_tree::Node), kp::Tensor::TensorDataTypes::eUnsignedInt);
+    quadTreeNodeSnapshots.reset(quadTreeNodes);
+    if (sharedRenderEntities) {
+        sharedQuadTreeNodes = gl_interop::SharedBuffer::create(*mgr, sizeof(gpu_quad_tree::Node) * quadTreeNodes.size());
+    }
 
-    quadTreeNodeUsedStatus.resize(quadTreeNodes->size() + 2);  // +2 since one is used as lock and one as next pointer
+    quadTreeNodeUsedStatus.resize(quadTreeNodes.size() + 2);  // +2 since one is used as lock and one as next pointer
     quadTreeNodeUsedStatus[1] = 2;  // Pointer to the first free node index;
     tensorQuadTreeNodeUsedStatus = mgr->tensor(quadTreeNodeUsedStatus.data(), quadTreeNodeUsedStatus.size(), sizeof(uint32_t), kp::Tensor::TensorDataTypes::eUnsignedInt);
 
@@ -88,44 +141,191 @@ void Simulator::init() {
     debugData.resize(10);
     tensorDebugData = mgr->tensor(debugData.data(), debugData.size(), sizeof(uint32_t), kp::Tensor::TensorDataTypes::eUnsignedInt);
 
-    params = {tensorEntities, tensorConnections, tensorRoads, tensorQuadTreeNodes, tensorQuadTreeEntities, tensorQuadTreeNodeUsedStatus, tensorDebugData};
+    params = {tensorEntityPositions, tensorEntityMotions, tensorEntityRoadIndices, tensorEntityCollisionBits, tensorEntityStates, tensorConnections, tensorRoads, tensorQuadTreeNodes, tensorQuadTreeEntities, tensorQuadTreeNodeUsedStatus, tensorDebugData, tensorEntityIds};
 
     // Push constants:
     pushConsts.emplace_back();
     pushConsts[0].worldSizeX = map->width;
     pushConsts[0].worldSizeY = map->height;
-    pushConsts[0].nodeCount = static_cast<uint32_t>(quadTreeNodes->size());
+    pushConsts[0].nodeCount = static_cast<uint32_t>(quadTreeNodes.size());
     pushConsts[0].maxDepth = QUAD_TREE_MAX_DEPTH;
     pushConsts[0].entityNodeCap = QUAD_TREE_ENTITY_NODE_CAP;
     pushConsts[0].collisionRadius = COLLISION_RADIUS;
     pushConsts[0].tick = 1;
+    pushConsts[0].collisionBackend = static_cast<uint32_t>(collisionBackend);
+    pushConsts[0].roadCount = static_cast<uint32_t>(map->roads.size());
+    pushConsts[0].dt = timeStep;
+    pushConsts[0].substeps = moveSubsteps;
+    pushConsts[0].seed = ENTITY_SEED;
 
     algo = mgr->algorithm<float, PushConsts>(params, shader, {}, {}, {pushConsts});
 
+    initEntitiesShader = std::vector(INIT_ENTITIES_COMP_SPV.begin(), INIT_ENTITIES_COMP_SPV.end());
+    algoInitEntities = mgr->algorithm<float, PushConsts>({tensorEntityPositions, tensorEntityMotions, tensorEntityRoadIndices, tensorEntityCollisionBits, tensorEntityStates, tensorEntityIds, tensorEntitySlots, tensorRoads}, initEntitiesShader, {static_cast<uint32_t>(MAX_ENTITIES), 1, 1}, {}, {pushConsts});
+
+    renderEntitiesShader = std::vector(RENDER_ENTITIES_COMP_SPV.begin(), RENDER_ENTITIES_COMP_SPV.end());
+    algoRenderEntities = mgr->algorithm<float, PushConsts>({tensorEntityPositions, tensorEntityStates, tensorEntityCollisionBits, tensorRenderEntities}, renderEntitiesShader, {static_cast<uint32_t>(MAX_ENTITIES), 1, 1}, {}, {pushConsts});
+
+    if (collisionBackend == CollisionBackend::ROAD_GRAPH) {
+        init_road_graph();
+    }
+
+    init_reorder();
+
+    // Ensure the data is on the GPU.
+    // Entities get generated directly on the GPU, so there is no need to upload them:
+    {
+        std::shared_ptr<kp::Sequence> sendSeq = mgr->sequence()->record<kp::OpTensorSyncDevice>({tensorConnections, tensorRoads, tensorQuadTreeNodes, tensorQuadTreeEntities, tensorQuadTreeNodeUsedStatus, tensorDebugData});
+        sendSeq->eval();
+    }
+    if (collisionBackend == CollisionBackend::ROAD_GRAPH) {
+        std::shared_ptr<kp::Sequence> sendSeq = mgr->sequence()->record<kp::OpTensorSyncDevice>({tensorRoadNeighbourStarts, tensorRoadNeighbours, tensorRoadEntityCounts, tensorRoadEntityStarts, tensorRoadEntities, tensorScanChunkSums});
+        sendSeq->eval();
+    }
+    init_entities();
+
     check_device_queues();
 
     initialized = true;
 }
 
+void Simulator::init_road_graph() {
+    assert(map);
+    assert(!map->roads.empty());
+
+    // One time spatial join to find all roads within the collision radius of each other:
+    roadNeighbours = gpu_road_graph::build_road_neighbours(*map, COLLISION_RADIUS);
+    if (roadNeighbours.neighbours.empty()) {
+        // Prevent empty buffers:
+        roadNeighbours.neighbours.push_back(0);
+    }
+    tensorRoadNeighbourStarts = mgr->tensor(roadNeighbours.neighbourStarts.data(), roadNeighbours.neighbourStarts.size(), sizeof(uint32_t), kp::Tensor::TensorDataTypes::eUnsignedInt);
+    tensorRoadNeighbours = mgr->tensor(roadNeighbours.neighbours.data(), roadNeighbours.neighbours.size(), sizeof(uint32_t), kp::Tensor::TensorDataTypes::eUnsignedInt);
+
+    std::vector<uint32_t> roadEntityCounts(map->roads.size(), 0);
+    tensorRoadEntityCounts = mgr->tensor(roadEntityCounts.data(), roadEntityCounts.size(), sizeof(uint32_t), kp::Tensor::TensorDataTypes::eUnsignedInt);
+    tensorRoadEntityStarts = mgr->tensor(roadEntityCounts.data(), roadEntityCounts.size(), sizeof(uint32_t), kp::Tensor::TensorDataTypes::eUnsignedInt);
+
+    static_assert(sizeof(gpu_road_graph::Entity) == sizeof(uint32_t) * 2, "Road graph entity size does not match. Expected to be constructed out of 2 uint32_t.");
+    std::vector<gpu_road_graph::Entity> roadEntities(MAX_ENTITIES);
+    tensorRoadEntities = mgr->tensor(roadEntities.data(), roadEntities.size(), sizeof(gpu_road_graph::Entity), kp::Tensor::TensorDataTypes::eUnsignedInt);
+
+    std::vector<uint32_t> scanChunkSums(gpu_road_graph::calc_scan_chunk_count(map->roads.size()), 0);
+    tensorScanChunkSums = mgr->tensor(scanChunkSums.data(), scanChunkSums.size(), sizeof(uint32_t), kp::Tensor::TensorDataTypes::eUnsignedInt);
+
+    roadGraphParams = {tensorEntityPositions, tensorEntityRoadIndices, tensorEntityCollisionBits, tensorRoads, tensorRoadNeighbourStarts, tensorRoadNeighbours, tensorRoadEntityCounts, tensorRoadEntityStarts, tensorRoadEntities, tensorScanChunkSums, tensorDebugData};
+
+    roadGraphShader = std::vector(ROAD_GRAPH_COMP_SPV.begin(), ROAD_GRAPH_COMP_SPV.end());
+    algoRoadGraphEntities = mgr->algorithm<float, PushConsts>(roadGraphParams, roadGraphShader, {static_cast<uint32_t>(MAX_ENTITIES), 1, 1}, {}, {pushConsts});
+    algoRoadGraphRoads = mgr->algorithm<float, PushConsts>(roadGraphParams, roadGraphShader, {static_cast<uint32_t>(map->roads.size()), 1, 1}, {}, {pushConsts});
+}
+
+void Simulator::record_road_graph_collision_detection(std::shared_ptr<kp::Sequence>& seq) {
+    assert(collisionBackend == CollisionBackend::ROAD_GRAPH);
+
+    // The push constants get copied while recording, so we can reuse the same vector for all passes:
+    std::vector<PushConsts> passConsts = pushConsts;
+    auto record_pass = [&seq, &passConsts](const std::shared_ptr<kp::Algorithm>& algo, gpu_road_graph::Pass pass) {
+        passConsts[0].pass = static_cast<uint32_t>(pass);
+        seq->record<kp::OpAlgoDispatch>(algo, passConsts);
+        // Every pass consumes the results of the previous one:
+        seq->record(std::make_shared<OpComputeBarrier>());
+    };
+
+    // 1.0 Group all entities by road:
+    record_pass(algoRoadGraphRoads, gpu_road_graph::Pass::CLEAR);
+    record_pass(algoRoadGraphEntities, gpu_road_graph::Pass::COUNT);
+    record_pass(algoRoadGraphRoads, gpu_road_graph::Pass::SCAN_CHUNKS);
+    record_pass(algoRoadGraphRoads, gpu_road_graph::Pass::SCAN_CHUNK_SUMS);
+    record_pass(algoRoadGraphRoads, gpu_road_graph::Pass::SCAN_ADD);
+    record_pass(algoRoadGraphEntities, gpu_road_graph::Pass::SCATTER);
+
+    // 2.0 Sort them by offset on each road:
+    record_pass(algoRoadGraphRoads, gpu_road_graph::Pass::SORT);
+
+    // 3.0 Scan the 1D windows on the own and all neighbouring roads:
+    record_pass(algoRoadGraphEntities, gpu_road_graph::Pass::COLLIDE);
+}
+
+void Simulator::init_reorder() {
+    std::vector<uint32_t> sortBuffer(MAX_ENTITIES, 0);
+    tensorSortKeysA = mgr->tensor(sortBuffer.data(), sortBuffer.size(), sizeof(uint32_t), kp::Tensor::TensorDataTypes::eUnsignedInt);
+    tensorSortValuesA = mgr->tensor(sortBuffer.data(), sortBuffer.size(), sizeof(uint32_t), kp::Tensor::TensorDataTypes::eUnsignedInt);
+    tensorSortKeysB = mgr->tensor(sortBuffer.data(), sortBuffer.size(), sizeof(uint32_t), kp::Tensor::TensorDataTypes::eUnsignedInt);
+    tensorSortValuesB = mgr->tensor(sortBuffer.data(), sortBuffer.size(), sizeof(uint32_t), kp::Tensor::TensorDataTypes::eUnsignedInt);
+
+    const size_t chunkCount = gpu_reorder::calc_sort_chunk_count(MAX_ENTITIES);
+    std::vector<uint32_t> sortHistograms(chunkCount * gpu_reorder::RADIX_BUCKET_COUNT, 0);
+    tensorSortHistograms = mgr->tensor(sortHistograms.data(), sortHistograms.size(), sizeof(uint32_t), kp::Tensor::TensorDataTypes::eUnsignedInt);
+    std::vector<uint32_t> sortBucketTotals(gpu_reorder::RADIX_BUCKET_COUNT, 0);
+    tensorSortBucketTotals = mgr->tensor(sortBucketTotals.data(), sortBucketTotals.size(), sizeof(uint32_t), kp::Tensor::TensorDataTypes::eUnsignedInt);
+
+    // Holds one attribute of all entities at a time while permuting:
+    std::vector<uint32_t> reorderScratch(MAX_ENTITIES * gpu_reorder::SCRATCH_STRIDE, 0);
+    tensorReorderScratch = mgr->tensor(reorderScratch.data(), reorderScratch.size(), sizeof(uint32_t), kp::Tensor::TensorDataTypes::eUnsignedInt);
+
+    reorderParams = {tensorEntityPositions, tensorEntityMotions, tensorEntityRoadIndices, tensorEntityStates, tensorEntityIds, tensorEntitySlots, tensorQuadTreeNodes, tensorQuadTreeEntities, tensorSortKeysA, tensorSortValuesA, tensorSortKeysB, tensorSortValuesB, tensorSortHistograms, tensorSortBucketTotals, tensorReorderScratch};
+
+    reorderShader = std::vector(REORDER_COMP_SPV.begin(), REORDER_COMP_SPV.end());
+    algoReorderEntities = mgr->algorithm<float, PushConsts>(reorderParams, reorderShader, {static_cast<uint32_t>(MAX_ENTITIES), 1, 1}, {}, {pushConsts});
+    algoReorderChunks = mgr->algorithm<float, PushConsts>(reorderParams, reorderShader, {static_cast<uint32_t>(chunkCount), 1, 1}, {}, {pushConsts});
+    algoReorderBuckets = mgr->algorithm<float, PushConsts>(reorderParams, reorderShader, {static_cast<uint32_t>(gpu_reorder::RADIX_BUCKET_COUNT), 1, 1}, {}, {pushConsts});
+    algoReorderQuadTreeNodes = mgr->algorithm<float, PushConsts>(reorderParams, reorderShader, {tensorQuadTreeNodes->size(), 1, 1}, {}, {pushConsts});
+}
+
+void Simulator::record_reorder(std::shared_ptr<kp::Sequence>& seq) {
+    std::vector<PushConsts> passConsts = pushConsts;
+    auto record_pass = [&seq, &passConsts](const std::shared_ptr<kp::Algorithm>& algo, gpu_reorder::Pass pass, uint32_t step) {
+        passConsts[0].pass = static_cast<uint32_t>(pass);
+        passConsts[0].reorderStep = step;
+        seq->record<kp::OpAlgoDispatch>(algo, passConsts);
+        // Every pass consumes the results of the previous one and each APPLY reads the scratch buffer its GATHER wrote, before the next GATHER overwrites it:
+        seq->record(std::make_shared<OpComputeBarrier>());
+    };
+
+    // 1.0 Sort all entity slots by the Morton code of the entity position:
+    record_pass(algoReorderEntities, gpu_reorder::Pass::KEYS, 0);
+    static_assert(gpu_reorder::RADIX_STEP_COUNT % 2 == 0, "The sorted result is expected to end up in the A buffers.");
+    for (uint32_t step = 0; step < gpu_reorder::RADIX_STEP_COUNT; step++) {
+        record_pass(algoReorderChunks, gpu_reorder::Pass::HISTOGRAM, step);
+        record_pass(algoReorderBuckets, gpu_reorder::Pass::SCAN_BUCKETS, step);
+        record_pass(algoReorderBuckets, gpu_reorder::Pass::SCAN_BUCKET_TOTALS, step);
+        record_pass(algoReorderChunks, gpu_reorder::Pass::SCATTER, step);
+    }
+    record_pass(algoReorderEntities, gpu_reorder::Pass::INVERT, 0);
+
+    // 2.0 Permute all per entity buffers one after another through the scratch buffer:
+    std::vector<gpu_reorder::Attribute> attributes{gpu_reorder::Attribute::POSITIONS, gpu_reorder::Attribute::MOTIONS, gpu_reorder::Attribute::ROAD_INDICES, gpu_reorder::Attribute::STATES, gpu_reorder::Attribute::IDS};
+    if (collisionBackend == CollisionBackend::QUAD_TREE) {
+        attributes.push_back(gpu_reorder::Attribute::QUAD_TREE_ENTITIES);
+    }
+    for (gpu_reorder::Attribute attribute : attributes) {
+        record_pass(algoReorderEntities, gpu_reorder::Pass::GATHER, static_cast<uint32_t>(attribute));
+        record_pass(algoReorderEntities, gpu_reorder::Pass::APPLY, static_cast<uint32_t>(attribute));
+    }
+
+    // 3.0 Rewrite all references to entity slots:
+    if (collisionBackend == CollisionBackend::QUAD_TREE) {
+        record_pass(algoReorderQuadTreeNodes, gpu_reorder::Pass::REMAP_QUAD_TREE_NODES, 0);
+    }
+    record_pass(algoReorderEntities, gpu_reorder::Pass::UPDATE_SLOTS, 0);
+}
+
 bool Simulator::is_initialized() const {
     return initialized;
 }
 
-void Simulator::add_entities() {
+void Simulator::init_entities() {
     assert(map);
-    entities->reserve(MAX_ENTITIES);
-    for (size_t i = 1; i <= MAX_ENTITIES; i++) {
-        const unsigned int roadIndex = map->get_random_road_index();
-        assert(roadIndex < map->roads.size());
-        const Road road = map->roads[roadIndex];
-        entities->push_back(Entity(Rgba::random_color(),
-                                   Vec4U::random_vec(),
-                                   Vec2(road.start.pos),
-                                   Vec2(road.end.pos),
-                                   {0, 0},
-                                   roadIndex,
-                                   false));
-    }
+    assert(!map->roads.empty());
+    SPDLOG_INFO("Generating {} entities with seed {}...", MAX_ENTITIES, ENTITY_SEED);
+    mgr->sequence()->eval<kp::OpAlgoDispatch>(algoInitEntities, pushConsts);
+    SPDLOG_INFO("Entities generated.");
+
+    // Preallocate all snapshots with the generated entities, so the UI has something to show before the first tick and retrieving entities only copies:
+    mgr->sequence()->record<kp::OpAlgoDispatch>(algoRenderEntities, pushConsts)->record<kp::OpTensorSyncLocal>({tensorRenderEntities})->eval();
+    entitySnapshots.reset(tensorRenderEntities->vector<RenderEntity>());
+    entitySnapshots.publish(simTick);
 }
 
 std::shared_ptr<Simulator>& Simulator::get_instance() {
@@ -140,22 +340,79 @@ SimulatorState Simulator::get_state() const {
     return state;
 }
 
-std::shared_ptr<std::vector<Entity>> Simulator::get_entities() {
-    std::shared_ptr<std::vector<Entity>> result = std::move(entities);
-    entities = nullptr;
-    return result;
+const utils::Snapshot<std::vector<RenderEntity>>* Simulator::get_entities() {
+    return entitySnapshots.acquire();
+}
+
+bool Simulator::has_new_entities() const {
+    if (useSharedRenderEntities) {
+        return sharedRenderEntitiesState == SharedEntitiesState::READY;
+    }
+    return entitySnapshots.has_unread();
+}
+
+void Simulator::set_entity_retrieve_interval(uint32_t interval) {
+    assert(interval > 0);
+    entityRetrieveInterval = interval;
 }
 
-std::shared_ptr<std::vector<gpu_quad_tree::Node>> Simulator::get_quad_tree_nodes() {
-    std::shared_ptr<std::vector<gpu_quad_tree::Node>> result = std::move(quadTreeNodes);
-    quadTreeNodes = nullptr;
-    return result;
+std::optional<gl_interop::SharedBufferHandle> Simulator::export_shared_entities() const {
+    if (!sharedRenderEntities) {
+        return std::nullopt;
+    }
+    return sharedRenderEntities->export_handle();
+}
+
+std::optional<gl_interop::SharedBufferSyncHandle> Simulator::export_shared_buffer_sync() const {
+    if (!sharedBufferSync) {
+        return std::nullopt;
+    }
+    return sharedBufferSync->export_handle();
+}
+
+void Simulator::enable_shared_entities() {
+    assert(sharedRenderEntities);
+    assert(sharedBufferSync);
+    useSharedRenderEntities = true;
+}
+
+bool Simulator::acquire_shared_entities() {
+    SharedEntitiesState expected = SharedEntitiesState::READY;
+    return sharedRenderEntitiesState.compare_exchange_strong(expected, SharedEntitiesState::IN_USE);
+}
+
+void Simulator::release_shared_entities() {
+    assert(sharedRenderEntitiesState == SharedEntitiesState::IN_USE);
+    sharedRenderEntitiesState = SharedEntitiesState::FREE;
+}
+
+std::optional<gl_interop::SharedBufferHandle> Simulator::export_shared_quad_tree_nodes() const {
+    if (!sharedQuadTreeNodes) {
+        return std::nullopt;
+    }
+    return sharedQuadTreeNodes->export_handle();
+}
+
+const utils::Snapshot<std::vector<gpu_quad_tree::Node>>* Simulator::get_quad_tree_nodes() {
+    return quadTreeNodeSnapshots.acquire();
+}
+
+bool Simulator::has_new_quad_tree_nodes() const {
+    return quadTreeNodeSnapshots.has_unread();
+}
+
+uint64_t Simulator::get_tick_generation() const {
+    return tickGeneration.load(std::memory_order_relaxed);
 }
 
 const std::shared_ptr<Map> Simulator::get_map() const {
     return map;
 }
 
+CollisionBackend Simulator::get_collision_backend() const {
+    return collisionBackend;
+}
+
 void Simulator::start_worker() {
     assert(initialized);
     assert(state == SimulatorState::STOPPED);
@@ -186,17 +443,27 @@ void Simulator::sim_worker() {
     assert(initialized);
     SPDLOG_INFO("Simulation thread started.");
 
-    // Ensure the data is on the GPU:
-    {
-        std::shared_ptr<kp::Sequence> sendSeq = mgr->sequence()->record<kp::OpTensorSyncDevice>(params);
-        sendSeq->eval();
-    }
-
+    // All data got uploaded and the entities got generated by init(), so restarting the thread continues where the last one stopped.
     // Prepare retrieve sequences:
     std::shared_ptr<kp::Sequence> calcSeq = mgr->sequence()->record<kp::OpAlgoDispatch>(algo);
-    std::shared_ptr<kp::Sequence> retrieveEntitiesSeq = mgr->sequence()->record<kp::OpTensorSyncLocal>({tensorEntities});
+    std::shared_ptr<kp::Sequence> roadGraphSeq{nullptr};
+    if (collisionBackend == CollisionBackend::ROAD_GRAPH) {
+        roadGraphSeq = mgr->sequence();
+        record_road_graph_collision_detection(roadGraphSeq);
+    }
+    std::shared_ptr<kp::Sequence> reorderSeq = mgr->sequence();
+    record_reorder(reorderSeq);
+    // Pack everything required for rendering into a single compact buffer and only retrieve this one:
+    std::shared_ptr<kp::Sequence> retrieveEntitiesSeq = mgr->sequence()->record<kp::OpAlgoDispatch>(algoRenderEntities, pushConsts)->record<kp::OpTensorSyncLocal>({tensorRenderEntities});
+    // Skips the host entirely by copying into the buffer shared with OpenGL on the device:
+    std::shared_ptr<kp::Sequence> shareEntitiesSeq{nullptr};
+    if (sharedRenderEntities) {
+        shareEntitiesSeq = mgr->sequence()->record<kp::OpAlgoDispatch>(algoRenderEntities, pushConsts)->record(std::make_shared<gl_interop::OpCopyToSharedBuffer>(tensorRenderEntities, sharedRenderEntities.get()));
+        if (sharedQuadTreeNodes) {
+            shareEntitiesSeq->record(std::make_shared<gl_interop::OpCopyToSharedBuffer>(tensorQuadTreeNodes, sharedQuadTreeNodes.get()));
+        }
+    }
     std::shared_ptr<kp::Sequence> retrieveQuadTreeNodesSeq = mgr->sequence()->record<kp::OpTensorSyncLocal>({tensorQuadTreeNodes});
-    std::shared_ptr<kp::Sequence> retrieveMiscSeq = mgr->sequence()->record<kp::OpTensorSyncLocal>({tensorQuadTreeNodeUsedStatus, tensorQuadTreeEntities, tensorDebugData});
 
     std::unique_lock<std::mutex> lk(waitMutex);
     while (state == SimulatorState::RUNNING) {
@@ -206,76 +473,114 @@ void Simulator::sim_worker() {
         if (!simulating) {
             continue;
         }
-        sim_tick(calcSeq, retrieveEntitiesSeq, retrieveQuadTreeNodesSeq, retrieveMiscSeq);
+        sim_tick(calcSeq, roadGraphSeq, reorderSeq, retrieveEntitiesSeq, shareEntitiesSeq, retrieveQuadTreeNodesSeq);
     }
 }
 
-void Simulator::sim_tick(std::shared_ptr<kp::Sequence>& calcSeq, std::shared_ptr<kp::Sequence>& retrieveEntitiesSeq, std::shared_ptr<kp::Sequence>& retrieveQuadTreeNodesSeq, std::shared_ptr<kp::Sequence>& retrieveMiscSeq) {
+void Simulator::sim_tick(std::shared_ptr<kp::Sequence>& calcSeq, std::shared_ptr<kp::Sequence>& roadGraphSeq, std::shared_ptr<kp::Sequence>& reorderSeq, std::shared_ptr<kp::Sequence>& retrieveEntitiesSeq, std::shared_ptr<kp::Sequence>& shareEntitiesSeq, std::shared_ptr<kp::Sequence>& retrieveQuadTreeNodesSeq) {
     std::chrono::high_resolution_clock::time_point tickStart = std::chrono::high_resolution_clock::now();
 
 #ifdef MOVEMENT_SIMULATOR_ENABLE_RENDERDOC_API
     start_frame_capture();
 #endif
-    // Update quad tree and move:
-    pushConsts[0].tick++;
-    uint32_t tick = pushConsts[0].tick;
-    SPDLOG_DEBUG("Update tick {} started.", tick);
+    // Keep entities that are close to each other close to each other in memory:
+    const uint32_t reorderInterval = entityReorderInterval;
+    if (reorderInterval > 0 && simTick > 0 && (simTick % reorderInterval) == 0) {
+        SPDLOG_DEBUG("Reordering entities in tick {}.", simTick);
+        reorderSeq->eval();
+    }
+
+    // Update quad tree and move.
+    // All move dispatches between two collision detection passes get submitted at once:
+    pushConsts[0].dt = timeStep;
+    pushConsts[0].substeps = moveSubsteps;
+    pushConsts[0].pass = static_cast<uint32_t>(MovePass::MOVE);
+    simTick++;
+    SPDLOG_DEBUG("Update tick {} started.", simTick);
     std::chrono::high_resolution_clock::time_point updateTickStart = std::chrono::high_resolution_clock::now();
-    calcSeq->eval<kp::OpAlgoDispatch>(algo, pushConsts);
+    calcSeq->clear();
+    const uint32_t moveDispatchCount = collisionDetectionInterval;
+    for (uint32_t i = 0; i < moveDispatchCount; i++) {
+        // Each substep moves the entities from where the previous one left them:
+        if (i > 0) {
+            calcSeq->record(std::make_shared<OpComputeBarrier>());
+        }
+        pushConsts[0].tick++;
+        calcSeq->record<kp::OpAlgoDispatch>(algo, pushConsts);
+    }
+    calcSeq->eval();
     std::chrono::nanoseconds durationUpdate = std::chrono::high_resolution_clock::now() - updateTickStart;
     updateTickHistory.add_time(durationUpdate);
-    tick = pushConsts[0].tick;
-    SPDLOG_DEBUG("Update tick {} ended.", tick);
+    SPDLOG_DEBUG("Update tick {} ended.", simTick);
 
     // Update collision detection:
     pushConsts[0].tick++;
-    tick = pushConsts[0].tick;
-    SPDLOG_DEBUG("Collision detection tick {} started.", tick);
+    pushConsts[0].pass = static_cast<uint32_t>(MovePass::COLLISION);
+    SPDLOG_DEBUG("Collision detection tick {} started.", simTick);
     std::chrono::high_resolution_clock::time_point collisionDetectionTickStart = std::chrono::high_resolution_clock::now();
-    calcSeq->eval<kp::OpAlgoDispatch>(algo, pushConsts);
+    if (collisionBackend == CollisionBackend::ROAD_GRAPH) {
+        roadGraphSeq->eval();
+    } else {
+        calcSeq->eval<kp::OpAlgoDispatch>(algo, pushConsts);
+    }
     std::chrono::nanoseconds durationCollisionDetection = std::chrono::high_resolution_clock::now() - collisionDetectionTickStart;
     collisionDetectionTickHistory.add_time(durationCollisionDetection);
 
-    write_log_csv_file(tick, durationUpdate, durationCollisionDetection, durationUpdate + durationCollisionDetection);
-    tick = pushConsts[0].tick;
-    SPDLOG_DEBUG("Collision detection tick {} ended.", tick);
+    write_log_csv_file(simTick, durationUpdate, durationCollisionDetection, durationUpdate + durationCollisionDetection);
+    SPDLOG_DEBUG("Collision detection tick {} ended.", simTick);
 
     // std::this_thread::sleep_for(std::chrono::milliseconds(100));
 #ifdef MOVEMENT_SIMULATOR_ENABLE_RENDERDOC_API
     end_frame_capture();
 #endif
 
-    bool retrievingEntities = !entities;
+    const bool sharingEntities = useSharedRenderEntities && sharedRenderEntitiesState == SharedEntitiesState::FREE;
+    if (sharingEntities) {
+        // OpenGL submitted the signal before releasing the shared buffers, so the wait always gets submitted after it:
+        if (sharedEntitiesHandedOver) {
+            sharedBufferSync->wait_released();
+        }
+        shareEntitiesSeq->evalAsync();
+        sharedBufferSync->signal_ready();
+        sharedEntitiesHandedOver = true;
+        // OpenGL waits for the copy on the device, so there is no need to wait for it on the host:
+        sharedRenderEntitiesState = SharedEntitiesState::READY;
+    }
+
+    // Only read back once the UI acquired the previous snapshot, since nobody would look at the skipped ones:
+    bool retrievingEntities = !useSharedRenderEntities && (simTick % entityRetrieveInterval) == 0 && !entitySnapshots.has_unread();
     if (retrievingEntities) {
         retrieveEntitiesSeq->evalAsync();
     }
 
-    bool retrievingQuadTreeNodes = !quadTreeNodes;
+    bool retrievingQuadTreeNodes = !quadTreeNodeSnapshots.has_unread();
     if (retrievingQuadTreeNodes) {
         retrieveQuadTreeNodesSeq->evalAsync();
     }
 
-    retrieveMiscSeq->evalAsync();
+    if (sharingEntities) {
+        shareEntitiesSeq->evalAwait();
+    }
 
     if (retrievingEntities) {
         retrieveEntitiesSeq->evalAwait();
-        entities = std::make_shared<std::vector<Entity>>(tensorEntities->vector<Entity>());
+        std::vector<RenderEntity>& snapshot = entitySnapshots.get_back();
+        std::copy_n(tensorRenderEntities->data<RenderEntity>(), snapshot.size(), snapshot.begin());
+        entitySnapshots.publish(simTick);
     }
 
     if (retrievingQuadTreeNodes) {
         retrieveQuadTreeNodesSeq->evalAwait();
-        quadTreeNodes = std::make_shared<std::vector<gpu_quad_tree::Node>>(tensorQuadTreeNodes->vector<gpu_quad_tree::Node>());
+        std::vector<gpu_quad_tree::Node>& snapshot = quadTreeNodeSnapshots.get_back();
+        std::copy_n(tensorQuadTreeNodes->data<gpu_quad_tree::Node>(), snapshot.size(), snapshot.begin());
+        quadTreeNodeSnapshots.publish(simTick);
     }
 
-    retrieveMiscSeq->evalAwait();
-    quadTreeNodeUsedStatus = tensorQuadTreeNodeUsedStatus->vector<uint32_t>();
-    quadTreeEntities = tensorQuadTreeEntities->vector<gpu_quad_tree::Entity>();
-    std::vector<uint32_t> debugData = tensorDebugData->vector<uint32_t>();
-
     tpsHistory.add_time(std::chrono::high_resolution_clock::now() - tickStart);
 
     // TPS counter:
     tps.tick();
+    tickGeneration.store(simTick, std::memory_order_relaxed);
 }
 
 void Simulator::continue_simulation() {
@@ -298,6 +603,22 @@ bool Simulator::is_simulating() const {
     return simulating;
 }
 
+void Simulator::set_time_step(float dt, uint32_t substeps) {
+    assert(dt > 0);
+    assert(substeps > 0);
+    timeStep = dt;
+    moveSubsteps = substeps;
+}
+
+void Simulator::set_collision_detection_interval(uint32_t interval) {
+    assert(interval > 0);
+    collisionDetectionInterval = interval;
+}
+
+void Simulator::set_entity_reorder_interval(uint32_t interval) {
+    entityReorderInterval = interval;
+}
+
 const utils::TickRate& Simulator::get_tps() const {
     return tps;
 }
@@ -335,7 +656,8 @@ void Simulator::check_device_queues() {
 }
 
 const std::filesystem::path& Simulator::get_log_csv_path() {
-    static const std::filesystem::path LOG_CSV_PATH{std::to_string(MAX_ENTITIES) + ".csv"};
+    // Include the collision backend so runs with different backends on the same map can be compared:
+    static const std::filesystem::path LOG_CSV_PATH{std::to_string(MAX_ENTITIES) + "_" + std::string(to_string(COLLISION_BACKEND)) + ".csv"};
     return LOG_CSV_PATH;
 }
 
@@ -394,8 +716,8 @@ void Simulator::write_log_csv_file(uint32_t tick, std::chrono::nanoseconds durat
     double secCollision = static_cast<double>(std::chrono::duration_cast<std::chrono::milliseconds>(durationCollision).count()) / 1000;
     double secAll = static_cast<double>(std::chrono::duration_cast<std::chrono::milliseconds>(durationAll).count()) / 1000;
 
-    (*logFile) << Simulator::get_time_stamp() << ";" << std::to_string(tick / 2) << ";" << secUpdate << ";" << secCollision << ";" << secAll << "\n";
-    std::cerr << Simulator::get_time_stamp() << ";" << std::to_string(tick / 2) << ";" << secUpdate << ";" << secCollision << ";" << secAll << "\n";
+    (*logFile) << Simulator::get_time_stamp() << ";" << std::to_string(tick) << ";" << secUpdate << ";" << secCollision << ";" << secAll << "\n";
+    std::cerr << Simulator::get_time_stamp() << ";" << std::to_string(tick) << ";" << secUpdate << ";" << secCollision << ";" << secAll << "\n";
     logFile->flush();
 }
 
@@ -1,11 +1,16 @@
 #pragma once
 
+#include "GlInterop.hpp"
 #include "GpuQuadTree.hpp"
+#include "GpuReorder.hpp"
+#include "GpuRoadGraph.hpp"
 #include "PushConsts.hpp"
 #include "sim/Entity.hpp"
 #include "utils/TickDurationHistory.hpp"
 #include "utils/TickRate.hpp"
+#include "utils/TripleBuffer.hpp"
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <cstddef>
@@ -14,7 +19,9 @@
 #include <kompute/Manager.hpp>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <sim/Map.hpp>
+#include <string_view>
 #include <thread>
 #include <type_traits>
 #include <vector>
@@ -30,9 +37,24 @@ enum class SimulatorState {
     JOINING
 };
 
+/**
+ * The spatial structure used for detecting collisions between entities.
+ * Values have to match the COLLISION_BACKEND_* constants inside random_move.comp.
+ **/
+enum class CollisionBackend : uint32_t {
+    /**
+     * A GPU quad tree over the whole world.
+     **/
+    QUAD_TREE = 0,
+    /**
+     * Entities sorted by their offset on each road combined with a precomputed list of neighbouring roads.
+     **/
+    ROAD_GRAPH = 1
+};
+
+std::string_view to_string(CollisionBackend backend);
+
 constexpr size_t MAX_ENTITIES = 1000000;
-constexpr float MAX_RENDER_RESOLUTION_X = 8192;  // Larger values result in errors when creating frame buffers
-constexpr float MAX_RENDER_RESOLUTION_Y = 8192;
 
 constexpr size_t QUAD_TREE_MAX_DEPTH = 8;
 constexpr size_t QUAD_TREE_ENTITY_NODE_CAP = 10;
@@ -42,6 +64,54 @@ constexpr size_t QUAD_TREE_ENTITY_NODE_CAP = 10;
  **/
 constexpr float COLLISION_RADIUS = 10;
 
+/**
+ * The collision backend used by the simulator.
+ **/
+constexpr CollisionBackend COLLISION_BACKEND = CollisionBackend::QUAD_TREE;
+
+/**
+ * Simulated seconds per integration step.
+ **/
+constexpr float TIME_STEP = 1;
+/**
+ * Number of integration steps the move kernel advances per dispatch.
+ **/
+constexpr uint32_t MOVE_SUBSTEPS = 1;
+/**
+ * Number of move dispatches between two collision detection passes.
+ **/
+constexpr uint32_t COLLISION_DETECTION_INTERVAL = 1;
+
+/**
+ * Seed for generating the initial entities on the GPU.
+ * The same seed always results in the same population.
+ **/
+constexpr uint32_t ENTITY_SEED = 42;
+
+/**
+ * Number of ticks between two maintenance passes that sort the entity storage by the Morton code of the entity positions.
+ * Results in entities that are close to each other being stored close to each other. 0 disables reordering.
+ **/
+constexpr uint32_t ENTITY_REORDER_INTERVAL = 100;
+
+/**
+ * Ownership of the render entities shared with OpenGL.
+ **/
+enum class SharedEntitiesState : uint32_t {
+    /**
+     * The simulation may write the next render entities.
+     **/
+    FREE = 0,
+    /**
+     * The copy of new render entities got submitted together with the signal of the ready semaphore and waits for the UI to acquire them.
+     **/
+    READY = 1,
+    /**
+     * The UI waits for the ready semaphore and copies out of the shared buffer.
+     **/
+    IN_USE = 2
+};
+
 class Simulator {
  private:
     bool initialized{false};
@@ -57,6 +127,17 @@ class Simulator {
     utils::TickDurationHistory tpsHistory{};
     utils::TickRate tps{};
 
+    // Set from other threads and read once at the start of every tick:
+    std::atomic<float> timeStep{TIME_STEP};
+    std::atomic<uint32_t> moveSubsteps{MOVE_SUBSTEPS};
+    std::atomic<uint32_t> collisionDetectionInterval{COLLISION_DETECTION_INTERVAL};
+    std::atomic<uint32_t> entityReorderInterval{ENTITY_REORDER_INTERVAL};
+    uint32_t simTick{0};
+    /**
+     * The last completed tick. Written by the simulation thread, so the UI can tell whether anything changed.
+     **/
+    std::atomic<uint64_t> tickGeneration{0};
+
     utils::TickDurationHistory updateTickHistory{};
     utils::TickDurationHistory collisionDetectionTickHistory{};
 
@@ -65,10 +146,40 @@ class Simulator {
     std::shared_ptr<kp::Algorithm> algo{nullptr};
     std::vector<std::shared_ptr<kp::Tensor>> params{};
 
+    std::vector<uint32_t> initEntitiesShader{};
+    std::shared_ptr<kp::Algorithm> algoInitEntities{nullptr};
+
+    std::vector<uint32_t> renderEntitiesShader{};
+    std::shared_ptr<kp::Algorithm> algoRenderEntities{nullptr};
+
     std::vector<PushConsts> pushConsts{};
 
-    std::shared_ptr<std::vector<Entity>> entities{std::make_shared<std::vector<Entity>>()};
-    std::shared_ptr<kp::Tensor> tensorEntities{nullptr};
+    /**
+     * Render entities read back for the UI in case they are not shared with OpenGL.
+     **/
+    utils::TripleBuffer<std::vector<RenderEntity>> entitySnapshots{};
+    std::atomic<uint32_t> entityRetrieveInterval{1};
+    // Entities are stored as structure of arrays, so each pass only touches the attributes it requires:
+    std::shared_ptr<kp::Tensor> tensorEntityPositions{nullptr};
+    std::shared_ptr<kp::Tensor> tensorEntityMotions{nullptr};
+    std::shared_ptr<kp::Tensor> tensorEntityRoadIndices{nullptr};
+    // One bit per entity, set in case the entity collided during the last collision pass:
+    std::shared_ptr<kp::Tensor> tensorEntityCollisionBits{nullptr};
+    std::shared_ptr<kp::Tensor> tensorEntityStates{nullptr};
+    // Map between the external entity IDs and the slots entities are currently stored at:
+    std::shared_ptr<kp::Tensor> tensorEntityIds{nullptr};
+    std::shared_ptr<kp::Tensor> tensorEntitySlots{nullptr};
+    std::shared_ptr<kp::Tensor> tensorRenderEntities{nullptr};
+    // Render entities shared with OpenGL. nullptr in case interop is not supported:
+    std::unique_ptr<gl_interop::SharedBuffer> sharedRenderEntities{nullptr};
+    std::unique_ptr<gl_interop::SharedBufferSync> sharedBufferSync{nullptr};
+    std::atomic<bool> useSharedRenderEntities{false};
+    std::atomic<SharedEntitiesState> sharedRenderEntitiesState{SharedEntitiesState::FREE};
+    /**
+     * True once the shared buffers got handed to OpenGL at least once, so OpenGL signals the released semaphore before handing them back.
+     * Only accessed by the simulation thread.
+     **/
+    bool sharedEntitiesHandedOver{false};
     std::shared_ptr<kp::Tensor> tensorConnections{nullptr};
     std::shared_ptr<kp::Tensor> tensorRoads{nullptr};
     std::shared_ptr<kp::Tensor> tensorDebugData{nullptr};
@@ -76,13 +187,56 @@ class Simulator {
     std::shared_ptr<Map> map{nullptr};
 
     // -----------------QuadTree-----------------
+    // quadTreeEntities and quadTreeNodeUsedStatus only hold the initial state uploaded to the GPU. They never get synced back:
     std::vector<gpu_quad_tree::Entity> quadTreeEntities;
-    std::shared_ptr<std::vector<gpu_quad_tree::Node>> quadTreeNodes{std::make_shared<std::vector<gpu_quad_tree::Node>>()};
+    utils::TripleBuffer<std::vector<gpu_quad_tree::Node>> quadTreeNodeSnapshots{};
     std::vector<uint32_t> quadTreeNodeUsedStatus;
 
     std::shared_ptr<kp::Tensor> tensorQuadTreeEntities{nullptr};
     std::shared_ptr<kp::Tensor> tensorQuadTreeNodes{nullptr};
     std::shared_ptr<kp::Tensor> tensorQuadTreeNodeUsedStatus{nullptr};
+    // Quad tree nodes shared with OpenGL. Updated together with the shared render entities:
+    std::unique_ptr<gl_interop::SharedBuffer> sharedQuadTreeNodes{nullptr};
+    // ------------------------------------------
+
+    // -----------------RoadGraph----------------
+    CollisionBackend collisionBackend{COLLISION_BACKEND};
+    gpu_road_graph::RoadNeighbours roadNeighbours{};
+
+    std::vector<uint32_t> roadGraphShader{};
+    std::vector<std::shared_ptr<kp::Tensor>> roadGraphParams{};
+    // One invocation per entity:
+    std::shared_ptr<kp::Algorithm> algoRoadGraphEntities{nullptr};
+    // One invocation per road:
+    std::shared_ptr<kp::Algorithm> algoRoadGraphRoads{nullptr};
+
+    std::shared_ptr<kp::Tensor> tensorRoadNeighbourStarts{nullptr};
+    std::shared_ptr<kp::Tensor> tensorRoadNeighbours{nullptr};
+    std::shared_ptr<kp::Tensor> tensorRoadEntityCounts{nullptr};
+    std::shared_ptr<kp::Tensor> tensorRoadEntityStarts{nullptr};
+    std::shared_ptr<kp::Tensor> tensorRoadEntities{nullptr};
+    std::shared_ptr<kp::Tensor> tensorScanChunkSums{nullptr};
+    // ------------------------------------------
+
+    // -----------------Reorder------------------
+    std::vector<uint32_t> reorderShader{};
+    std::vector<std::shared_ptr<kp::Tensor>> reorderParams{};
+    // One invocation per entity:
+    std::shared_ptr<kp::Algorithm> algoReorderEntities{nullptr};
+    // One invocation per sort chunk:
+    std::shared_ptr<kp::Algorithm> algoReorderChunks{nullptr};
+    // One invocation per radix bucket:
+    std::shared_ptr<kp::Algorithm> algoReorderBuckets{nullptr};
+    // One invocation per quad tree node:
+    std::shared_ptr<kp::Algorithm> algoReorderQuadTreeNodes{nullptr};
+
+    std::shared_ptr<kp::Tensor> tensorSortKeysA{nullptr};
+    std::shared_ptr<kp::Tensor> tensorSortValuesA{nullptr};
+    std::shared_ptr<kp::Tensor> tensorSortKeysB{nullptr};
+    std::shared_ptr<kp::Tensor> tensorSortValuesB{nullptr};
+    std::shared_ptr<kp::Tensor> tensorSortHistograms{nullptr};
+    std::shared_ptr<kp::Tensor> tensorSortBucketTotals{nullptr};
+    std::shared_ptr<kp::Tensor> tensorReorderScratch{nullptr};
     // ------------------------------------------
 
 #ifdef MOVEMENT_SIMULATOR_ENABLE_RENDERDOC_API
@@ -108,20 +262,94 @@ class Simulator {
     void continue_simulation();
     void pause_simulation();
     [[nodiscard]] bool is_simulating() const;
+    /**
+     * Sets the simulated seconds per integration step and the number of integration steps per move dispatch.
+     * Gets applied with the next tick.
+     **/
+    void set_time_step(float dt, uint32_t substeps);
+    /**
+     * Sets the number of move dispatches between two collision detection passes.
+     * Gets applied with the next tick.
+     **/
+    void set_collision_detection_interval(uint32_t interval);
+    /**
+     * Sets the number of ticks between two passes sorting the entity storage by the Morton code of the entity positions.
+     * 0 disables reordering. Gets applied with the next tick.
+     **/
+    void set_entity_reorder_interval(uint32_t interval);
     [[nodiscard]] const utils::TickRate& get_tps() const;
     [[nodiscard]] const utils::TickDurationHistory& get_tps_history() const;
     [[nodiscard]] const utils::TickDurationHistory& get_update_tick_history() const;
     [[nodiscard]] const utils::TickDurationHistory& get_collision_detection_tick_history() const;
-    std::shared_ptr<std::vector<Entity>> get_entities();
-    std::shared_ptr<std::vector<gpu_quad_tree::Node>> get_quad_tree_nodes();
+    /**
+     * Returns the newest render entities in case they changed since the last call, else nullptr.
+     * The generation of the snapshot is the tick it got taken in.
+     * The snapshot stays valid until the next call. Only called from the UI thread.
+     **/
+    const utils::Snapshot<std::vector<RenderEntity>>* get_entities();
+    /**
+     * Returns true in case there are render entities the UI did not acquire yet, either via get_entities() or the shared buffer.
+     * Does not acquire them.
+     **/
+    [[nodiscard]] bool has_new_entities() const;
+    /**
+     * Only reads back render entities in ticks that are a multiple of the given interval.
+     * Ticks in which the previous entities have not been acquired yet get skipped, so the simulation never waits for the reader.
+     **/
+    void set_entity_retrieve_interval(uint32_t interval);
+    /**
+     * Exports the render entity buffer for importing it into OpenGL.
+     * Returns std::nullopt in case Vulkan OpenGL interop is not supported.
+     **/
+    [[nodiscard]] std::optional<gl_interop::SharedBufferHandle> export_shared_entities() const;
+    /**
+     * Exports the semaphores used for handing the shared buffers over.
+     * Returns std::nullopt in case Vulkan OpenGL interop is not supported.
+     **/
+    [[nodiscard]] std::optional<gl_interop::SharedBufferSyncHandle> export_shared_buffer_sync() const;
+    /**
+     * Switches from copying render entities via get_entities() to writing them into the shared buffer.
+     * Should only be called once the shared buffer and the semaphores have been imported successfully.
+     **/
+    void enable_shared_entities();
+    /**
+     * Returns true in case new render entities are available in the shared buffer.
+     * The UI then has to wait for the ready semaphore before reading the shared buffers.
+     * The simulation does not touch the shared buffers until release_shared_entities() gets called.
+     **/
+    bool acquire_shared_entities();
+    /**
+     * The UI has to have submitted the signal of the released semaphore (including a flush) before calling this.
+     **/
+    void release_shared_entities();
+    /**
+     * The quad tree nodes get copied into their shared buffer together with the shared render entities.
+     * So they are protected by acquire_shared_entities() and release_shared_entities() as well.
+     **/
+    [[nodiscard]] std::optional<gl_interop::SharedBufferHandle> export_shared_quad_tree_nodes() const;
+    /**
+     * Returns the newest quad tree nodes in case they changed since the last call, else nullptr.
+     * The snapshot stays valid until the next call. Only called from the UI thread.
+     **/
+    const utils::Snapshot<std::vector<gpu_quad_tree::Node>>* get_quad_tree_nodes();
+    [[nodiscard]] bool has_new_quad_tree_nodes() const;
+    /**
+     * The number of the last completed tick. Does not change while the simulation is paused.
+     **/
+    [[nodiscard]] uint64_t get_tick_generation() const;
     [[nodiscard]] const std::shared_ptr<Map> get_map() const;
+    [[nodiscard]] CollisionBackend get_collision_backend() const;
 
     [[nodiscard]] bool is_initialized() const;
 
  private:
     void sim_worker();
-    void sim_tick(std::shared_ptr<kp::Sequence>& calcSeq, std::shared_ptr<kp::Sequence>& retrieveEntitiesSeq, std::shared_ptr<kp::Sequence>& retrieveQuadTreeNodesSeq, std::shared_ptr<kp::Sequence>& retrieveMiscSeq);
-    void add_entities();
+    void sim_tick(std::shared_ptr<kp::Sequence>& calcSeq, std::shared_ptr<kp::Sequence>& roadGraphSeq, std::shared_ptr<kp::Sequence>& reorderSeq, std::shared_ptr<kp::Sequence>& retrieveEntitiesSeq, std::shared_ptr<kp::Sequence>& shareEntitiesSeq, std::shared_ptr<kp::Sequence>& retrieveQuadTreeNodesSeq);
+    void init_entities();
+    void init_road_graph();
+    void record_road_graph_collision_detection(std::shared_ptr<kp::Sequence>& seq);
+    void init_reorder();
+    void record_reorder(std::shared_ptr<kp::Sequence>& seq);
     void check_device_queues();
     static const std::filesystem::path& get_log_csv_path();
     void prepare_log_csv_file();
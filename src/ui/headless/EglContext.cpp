@@ -0,0 +1,92 @@
+#include "EglContext.hpp"
+#include "logger/Logger.hpp"
+#include "spdlog/spdlog.h"
+#include <array>
+#include <epoxy/gl.h>
+
+namespace ui::headless {
+bool EglContext::init() {
+    // Prefer the surfaceless platform, since it does not require any display server or GPU:
+    if (epoxy_has_egl_extension(EGL_NO_DISPLAY, "EGL_MESA_platform_surfaceless")) {
+        display = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (display == EGL_NO_DISPLAY) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    if (display == EGL_NO_DISPLAY) {
+        SPDLOG_ERROR("Failed to get an EGL display.");
+        return false;
+    }
+
+    EGLint major = 0;
+    EGLint minor = 0;
+    if (!eglInitialize(display, &major, &minor)) {
+        SPDLOG_ERROR("Failed to initialize EGL with error 0x{:X}.", eglGetError());
+        return false;
+    }
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        SPDLOG_ERROR("EGL {}.{} does not support desktop OpenGL.", major, minor);
+        return false;
+    }
+
+    // Without surfaceless contexts a tiny pbuffer has to be current, even though we never draw to it:
+    const bool surfaceless = epoxy_has_egl_extension(display, "EGL_KHR_surfaceless_context");
+    const std::array<EGLint, 5> configAttribs{
+        EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE};
+    EGLConfig config = nullptr;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttribs.data(), &config, 1, &configCount) || configCount <= 0) {
+        SPDLOG_ERROR("No EGL config supporting OpenGL found.");
+        return false;
+    }
+
+    const std::array<EGLint, 7> contextAttribs{
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 5,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE};
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs.data());
+    if (context == EGL_NO_CONTEXT) {
+        SPDLOG_ERROR("Failed to create an OpenGL 4.5 core context with error 0x{:X}.", eglGetError());
+        return false;
+    }
+
+    if (!surfaceless) {
+        const std::array<EGLint, 5> surfaceAttribs{EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+        surface = eglCreatePbufferSurface(display, config, surfaceAttribs.data());
+        if (surface == EGL_NO_SURFACE) {
+            SPDLOG_ERROR("Failed to create an EGL pbuffer surface with error 0x{:X}.", eglGetError());
+            return false;
+        }
+    }
+
+    if (!eglMakeCurrent(display, surface, surface, context)) {
+        SPDLOG_ERROR("Failed to make the EGL context current with error 0x{:X}.", eglGetError());
+        return false;
+    }
+
+    // NOLINTNEXTLINE (cppcoreguidelines-pro-type-reinterpret-cast)
+    SPDLOG_INFO("Created {} headless OpenGL {} context on '{}'.", surfaceless ? "a surfaceless" : "a pbuffer", reinterpret_cast<const char*>(glGetString(GL_VERSION)), reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+    return true;
+}
+
+void EglContext::cleanup() {
+    if (display == EGL_NO_DISPLAY) {
+        return;
+    }
+
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (surface != EGL_NO_SURFACE) {
+        eglDestroySurface(display, surface);
+        surface = EGL_NO_SURFACE;
+    }
+    if (context != EGL_NO_CONTEXT) {
+        eglDestroyContext(display, context);
+        context = EGL_NO_CONTEXT;
+    }
+    eglTerminate(display);
+    display = EGL_NO_DISPLAY;
+}
+}  // namespace ui::headless
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <epoxy/egl.h>
+
+namespace ui::headless {
+/**
+ * OpenGL 4.5 core context without any window or display server.
+ * Uses the Mesa surfaceless platform in case it is available (e.g. llvmpipe) and falls back to a pbuffer surface on the default display.
+ * There is no default frame buffer, so everything has to be drawn into frame buffer objects.
+ **/
+class EglContext {
+ private:
+    EGLDisplay display{EGL_NO_DISPLAY};
+    EGLContext context{EGL_NO_CONTEXT};
+    EGLSurface surface{EGL_NO_SURFACE};
+
+ public:
+    EglContext() = default;
+    EglContext(EglContext& other) = delete;
+    EglContext(EglContext&& old) = delete;
+
+    ~EglContext() = default;
+
+    EglContext& operator=(EglContext& other) = delete;
+    EglContext& operator=(EglContext&& old) = delete;
+
+    /**
+     * Creates the context and makes it current on the calling thread.
+     * Returns false in case no suitable context could be created.
+     **/
+    bool init();
+    void cleanup();
+};
+}  // namespace ui::headless
@@ -0,0 +1,113 @@
+#include "FrameWriter.hpp"
+#include "logger/Logger.hpp"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <fmt/core.h>
+#include <gdkmm/pixbuf.h>
+#include <glibmm/error.h>
+
+namespace ui::headless {
+FrameWriter::~FrameWriter() {
+    stop();
+}
+
+void FrameWriter::start(std::filesystem::path outputDir, FrameFormat format) {
+    assert(!thread.joinable());
+
+    this->outputDir = std::move(outputDir);
+    this->format = format;
+    std::filesystem::create_directories(this->outputDir);
+
+    shouldRun = true;
+    thread = std::thread(&FrameWriter::writer_thread_func, this);
+    SPDLOG_INFO("Writing frames to '{}'.", this->outputDir.string());
+}
+
+void FrameWriter::stop() {
+    if (!thread.joinable()) {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        shouldRun = false;
+    }
+    condVar.notify_all();
+    thread.join();
+}
+
+std::vector<uint8_t> FrameWriter::get_buffer(size_t size) {
+    std::vector<uint8_t> buffer;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!freeBuffers.empty()) {
+            buffer = std::move(freeBuffers.back());
+            freeBuffers.pop_back();
+        }
+    }
+    buffer.resize(size);
+    return buffer;
+}
+
+void FrameWriter::push(Frame&& frame) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condVar.wait(lock, [this]() { return queue.size() < MAX_QUEUED_FRAMES || !shouldRun; });
+        queue.push_back(std::move(frame));
+    }
+    condVar.notify_all();
+}
+
+void FrameWriter::writer_thread_func() {
+    SPDLOG_INFO("Frame writer thread started.");
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        condVar.wait(lock, [this]() { return !queue.empty() || !shouldRun; });
+        if (queue.empty()) {
+            break;
+        }
+
+        Frame frame = std::move(queue.front());
+        queue.pop_front();
+        lock.unlock();
+        condVar.notify_all();
+
+        write(frame);
+
+        lock.lock();
+        freeBuffers.push_back(std::move(frame.pixels));
+    }
+    SPDLOG_INFO("Frame writer thread stopped.");
+}
+
+void FrameWriter::write(Frame& frame) const {
+    // OpenGL reads rows bottom to top, while images are stored top to bottom:
+    const size_t stride = static_cast<size_t>(frame.width) * 4;
+    for (size_t top = 0, bottom = static_cast<size_t>(frame.height) - 1; top < bottom; top++, bottom--) {
+        std::swap_ranges(frame.pixels.begin() + static_cast<std::ptrdiff_t>(top * stride), frame.pixels.begin() + static_cast<std::ptrdiff_t>((top + 1) * stride), frame.pixels.begin() + static_cast<std::ptrdiff_t>(bottom * stride));
+    }
+
+    if (format == FrameFormat::RAW) {
+        const std::filesystem::path path = outputDir / fmt::format("frame_{:010}_{}x{}.rgba", frame.tick, frame.width, frame.height);
+        std::ofstream file(path, std::ios::binary);
+        // NOLINTNEXTLINE (cppcoreguidelines-pro-type-reinterpret-cast)
+        file.write(reinterpret_cast<const char*>(frame.pixels.data()), static_cast<std::streamsize>(frame.pixels.size()));
+        if (!file) {
+            SPDLOG_ERROR("Failed to write frame '{}'.", path.string());
+        }
+        return;
+    }
+
+    const std::filesystem::path path = outputDir / fmt::format("frame_{:010}.png", frame.tick);
+    try {
+        const Glib::RefPtr<Gdk::Pixbuf> pixbuf = Gdk::Pixbuf::create_from_data(frame.pixels.data(), Gdk::Colorspace::RGB, true, 8, frame.width, frame.height, static_cast<int>(stride));
+        pixbuf->save(path.string(), "png");
+    } catch (const Glib::Error& e) {
+        SPDLOG_ERROR("Failed to write frame '{}': {}", path.string(), e.what());
+    }
+}
+}  // namespace ui::headless
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ui::headless {
+enum class FrameFormat : uint8_t {
+    PNG,
+    /**
+     * Uncompressed 8 bit RGBA rows from top to bottom. Way cheaper to write than PNG.
+     **/
+    RAW
+};
+
+struct Frame {
+    uint64_t tick{0};
+    int32_t width{0};
+    int32_t height{0};
+    /**
+     * 8 bit RGBA rows from bottom to top, as read back by glReadPixels.
+     **/
+    std::vector<uint8_t> pixels;
+};
+
+/**
+ * Writes frames to disk from its own thread, so encoding never blocks rendering or the simulation.
+ * Pixel buffers get recycled to prevent allocating one per frame.
+ **/
+class FrameWriter {
+ private:
+    /**
+     * Frames queued at most. Pushing more blocks the rendering thread until the writer caught up.
+     **/
+    static constexpr size_t MAX_QUEUED_FRAMES = 4;
+
+    std::filesystem::path outputDir;
+    FrameFormat format{FrameFormat::PNG};
+
+    std::mutex mutex;
+    std::condition_variable condVar;
+    std::deque<Frame> queue;
+    std::vector<std::vector<uint8_t>> freeBuffers;
+    bool shouldRun{false};
+    std::thread thread;
+
+ public:
+    FrameWriter() = default;
+    FrameWriter(FrameWriter& other) = delete;
+    FrameWriter(FrameWriter&& old) = delete;
+
+    ~FrameWriter();
+
+    FrameWriter& operator=(FrameWriter& other) = delete;
+    FrameWriter& operator=(FrameWriter&& old) = delete;
+
+    void start(std::filesystem::path outputDir, FrameFormat format);
+    /**
+     * Writes all queued frames and joins the writer thread.
+     **/
+    void stop();
+
+    /**
+     * Returns a buffer of the given size to read the next frame into.
+     **/
+    std::vector<uint8_t> get_buffer(size_t size);
+    void push(Frame&& frame);
+
+ private:
+    void writer_thread_func();
+    void write(Frame& frame) const;
+};
+}  // namespace ui::headless
@@ -0,0 +1,146 @@
+#include "HeadlessRenderer.hpp"
+#include "logger/Logger.hpp"
+#include "sim/Entity.hpp"
+#include "spdlog/spdlog.h"
+#include "ui/widgets/opengl/utils/Utils.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <epoxy/gl_generated.h>
+#include <giomm/init.h>
+
+namespace ui::headless {
+HeadlessRenderer::HeadlessRenderer(HeadlessRenderSettings settings) : simulator(sim::Simulator::get_instance()),
+                                                                      settings(std::move(settings)),
+                                                                      mapTileAtlasFrameBuffer(widgets::opengl::tiles::ATLAS_SIZE_X, widgets::opengl::tiles::ATLAS_SIZE_Y),
+                                                                      entitiesFrameBuffer(this->settings.width, this->settings.height),
+                                                                      imageFrameBuffer(this->settings.width, this->settings.height) {
+    assert(this->settings.interval > 0);
+    assert(this->settings.width > 0 && this->settings.height > 0);
+}
+
+bool HeadlessRenderer::init() {
+    assert(simulator);
+
+    // Shaders get loaded from the resources, which requires glibmm to be set up since there is no Gtk::Application:
+    Gio::init();
+    if (!context.init()) {
+        return false;
+    }
+
+    mapTileAtlasFrameBuffer.init();
+    entitiesFrameBuffer.init();
+    imageFrameBuffer.init();
+
+    // The view matrix shared by all shaders drawing in map coordinates:
+    glGenBuffers(1, &cameraUbo);
+    glBindBuffer(GL_UNIFORM_BUFFER, cameraUbo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(float) * 16, nullptr, GL_STATIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, widgets::opengl::CAMERA_UNIFORM_BINDING, cameraUbo);
+
+    // Fit the whole map into the image:
+    const float width = static_cast<float>(settings.width);
+    const float height = static_cast<float>(settings.height);
+    camera.set_viewport_size({width, height});
+    camera.set_center({0.5F, 0.5F});
+    camera.set_zoom_factor(std::min(width, height) / widgets::opengl::CAMERA_MAP_PIXELS);
+    const std::array<float, 16> viewMatrix = camera.calc_view_matrix();
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(viewMatrix), viewMatrix.data());
+    GLERR;
+
+    mapObj.init();
+    mapTileObj.init();
+    mapTileObj.bind_texture(mapTileAtlasFrameBuffer.get_texture());
+    mapTileRasterObj.init();
+    mapTileCache.start(simulator->get_map());
+    entityObj.init();
+    // Neither the quad tree grid nor trails get drawn:
+    screenSquareObj.bind_texture(entitiesFrameBuffer.get_texture(), 0, 0);
+    screenSquareObj.init();
+    prepare_map_tiles();
+
+    // Only the ticks we render get read back from the GPU:
+    simulator->set_entity_retrieve_interval(settings.interval);
+    frameWriter.start(settings.outputDir, settings.format);
+    SPDLOG_INFO("Headless renderer initialized. Rendering every {}. tick at {}x{}.", settings.interval, settings.width, settings.height);
+    return true;
+}
+
+void HeadlessRenderer::prepare_map_tiles() {
+    const widgets::opengl::tiles::TileView view = widgets::opengl::tiles::calc_tile_view(camera);
+    mapTileAtlasFrameBuffer.bind();
+    while (true) {
+        mapTileObj.set_quads(mapTileCache.prepare_view(view));
+        for (const widgets::opengl::tiles::TileUpload& upload : mapTileCache.take_uploads()) {
+            mapTileRasterObj.set_upload(&upload);
+            mapTileRasterObj.render();
+        }
+        mapTileRasterObj.set_upload(nullptr);
+
+        if (!mapTileCache.has_pending()) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    GLERR;
+}
+
+bool HeadlessRenderer::render_next() {
+    assert(simulator);
+
+    // The simulation only publishes every settings.interval ticks, so each snapshot gets rendered:
+    const utils::Snapshot<std::vector<sim::RenderEntity>>* entities = simulator->get_entities();
+    if (!entities) {
+        return false;
+    }
+
+    glDisable(GL_DEPTH_TEST);
+
+    // 1.0 Draw entities to buffer:
+    entitiesFrameBuffer.bind();
+    glClearColor(0, 0, 0, 0);
+    glClear(GL_COLOR_BUFFER_BIT);
+    entityObj.set_entities(entities->data);
+    entityObj.render();
+
+    // 2.0 Compose the image the same way the SimulationWidget draws to screen:
+    imageFrameBuffer.bind();
+    glClearColor(0, 0, 0, 0);
+    glClear(GL_COLOR_BUFFER_BIT);
+    mapTileObj.render();
+    mapObj.render();
+    screenSquareObj.render();
+    GLERR;
+
+    // 3.0 Read back and hand over to the writer thread:
+    Frame frame{entities->generation, settings.width, settings.height, frameWriter.get_buffer(static_cast<size_t>(settings.width) * static_cast<size_t>(settings.height) * 4)};
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, settings.width, settings.height, GL_RGBA, GL_UNSIGNED_BYTE, frame.pixels.data());
+    GLERR;
+    frameWriter.push(std::move(frame));
+    return true;
+}
+
+void HeadlessRenderer::cleanup() {
+    frameWriter.stop();
+    mapTileCache.stop();
+
+    mapObj.cleanup();
+    mapTileObj.cleanup();
+    mapTileRasterObj.cleanup();
+    entityObj.cleanup();
+    screenSquareObj.cleanup();
+
+    imageFrameBuffer.cleanup();
+    entitiesFrameBuffer.cleanup();
+    mapTileAtlasFrameBuffer.cleanup();
+    glDeleteBuffers(1, &cameraUbo);
+    cameraUbo = 0;
+
+    context.cleanup();
+}
+}  // namespace ui::headless
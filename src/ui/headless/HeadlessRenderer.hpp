@@ -0,0 +1,91 @@
+#pragma once
+
+#include "EglContext.hpp"
+#include "FrameWriter.hpp"
+#include "sim/Simulator.hpp"
+#include "ui/widgets/opengl/Camera.hpp"
+#include "ui/widgets/opengl/EntityGlObject.hpp"
+#include "ui/widgets/opengl/MapGlObject.hpp"
+#include "ui/widgets/opengl/MapTileCache.hpp"
+#include "ui/widgets/opengl/MapTileGlObject.hpp"
+#include "ui/widgets/opengl/MapTileRasterGlObject.hpp"
+#include "ui/widgets/opengl/ScreenSquareGlObject.hpp"
+#include "ui/widgets/opengl/fb/EntitiesFrameBuffer.hpp"
+#include "ui/widgets/opengl/fb/ImageFrameBuffer.hpp"
+#include "ui/widgets/opengl/fb/MapTileAtlasFrameBuffer.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <epoxy/gl.h>
+
+namespace ui::headless {
+struct HeadlessRenderSettings {
+    std::filesystem::path outputDir;
+    /**
+     * Render every Nth simulation tick.
+     **/
+    uint32_t interval{1};
+    int32_t width{1920};
+    int32_t height{1080};
+    FrameFormat format{FrameFormat::PNG};
+};
+
+/**
+ * Renders the simulation to an image sequence without any window, using the same OpenGL objects and frame buffers as the SimulationWidget.
+ * Works on software renderers like llvmpipe, so it can be used for visual regression checks and recordings on machines without a display.
+ * All methods have to be called from the same thread, since it owns the OpenGL context.
+ **/
+class HeadlessRenderer {
+ private:
+    std::shared_ptr<sim::Simulator> simulator{nullptr};
+    HeadlessRenderSettings settings;
+
+    EglContext context{};
+    FrameWriter frameWriter{};
+
+    widgets::opengl::EntityGlObject entityObj{};
+    widgets::opengl::MapGlObject mapObj{};
+    widgets::opengl::MapTileGlObject mapTileObj{};
+    widgets::opengl::MapTileRasterGlObject mapTileRasterObj{};
+    widgets::opengl::ScreenSquareGlObject screenSquareObj{};
+
+    widgets::opengl::fb::MapTileAtlasFrameBuffer mapTileAtlasFrameBuffer;
+    widgets::opengl::fb::EntitiesFrameBuffer entitiesFrameBuffer;
+    widgets::opengl::fb::ImageFrameBuffer imageFrameBuffer;
+    widgets::opengl::tiles::MapTileCache mapTileCache{};
+    widgets::opengl::Camera camera{};
+    GLuint cameraUbo{0};
+
+ public:
+    explicit HeadlessRenderer(HeadlessRenderSettings settings);
+    HeadlessRenderer(HeadlessRenderer& other) = delete;
+    HeadlessRenderer(HeadlessRenderer&& old) = delete;
+
+    ~HeadlessRenderer() = default;
+
+    HeadlessRenderer& operator=(HeadlessRenderer& other) = delete;
+    HeadlessRenderer& operator=(HeadlessRenderer&& old) = delete;
+
+    /**
+     * Creates the OpenGL context and all objects and starts the frame writer.
+     * Returns false in case no OpenGL context could be created.
+     **/
+    bool init();
+    /**
+     * Renders the newest entities in case the simulation published new ones since the last call.
+     * Returns true in case a frame got rendered.
+     **/
+    bool render_next();
+    /**
+     * Writes all queued frames and frees all OpenGL resources.
+     **/
+    void cleanup();
+
+ private:
+    /**
+     * Blocks until all map tiles visible through the camera have been rasterized into the atlas.
+     * The camera never moves, so this is only required once.
+     **/
+    void prepare_map_tiles();
+};
+}  // namespace ui::headless
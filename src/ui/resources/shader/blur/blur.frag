@@ -2,21 +2,70 @@
 
 in vec2 fTexCoordinates;
 
+// The trail written by the previous pass:
 uniform sampler2D inputTexture;
-layout(std140, binding = 0) uniform blurArrayBlock {
-    vec2 offsets[9];
-};
+// The full resolution entities of the current frame:
+uniform sampler2D entitiesTexture;
+
+uniform uint pass;
+// Number of entity pixels along each axis one trail pixel covers:
+uniform int downsampling;
+// Weight of each of the two neighbours, the center gets the rest:
+uniform float sideWeight;
 
 out vec4 outColor;
 
+// Has to match ui::widgets::opengl::BlurPass:
+const uint PASS_HORIZONTAL = 0;
+const uint PASS_VERTICAL = 1;
+
+// Alpha kept per trail update:
+const float DECAY = 0.995;
+
+vec4 blur(vec2 direction)
+{
+    vec2 step = direction / vec2(textureSize(inputTexture, 0));
+    return texture(inputTexture, fTexCoordinates - step) * sideWeight
+         + texture(inputTexture, fTexCoordinates) * (1 - (2 * sideWeight))
+         + texture(inputTexture, fTexCoordinates + step) * sideWeight;
+}
+
+/**
+ * Averages the entity pixels covered by this trail pixel.
+ * Every bilinear sample between four entity pixels averages them, so a block of downsampling x downsampling pixels requires (downsampling / 2)² samples.
+ * Keeps the strongest alpha so single entities do not fade into the background.
+ **/
+vec4 sample_entities()
+{
+    vec2 entityStep = 1 / vec2(textureSize(entitiesTexture, 0));
+    int taps = max(downsampling / 2, 1);
+    vec3 color = vec3(0);
+    float alphaSum = 0;
+    float alphaMax = 0;
+    for(int y = 0; y < taps; y++) {
+        for(int x = 0; x < taps; x++) {
+            vec2 offset = downsampling == 1 ? vec2(0) : vec2((2 * x) + 1 - taps, (2 * y) + 1 - taps);
+            vec4 entity = texture(entitiesTexture, fTexCoordinates + (offset * entityStep));
+            color += entity.xyz * entity.w;
+            alphaSum += entity.w;
+            alphaMax = max(alphaMax, entity.w);
+        }
+    }
+    return alphaSum > 0 ? vec4(color / alphaSum, alphaMax) : vec4(0);
+}
+
 void main()
 {
-    outColor = vec4(0);
-    for(int i = 0; i < 9; i++) {
-        vec2 pos = fTexCoordinates + offsets[i];
-        outColor += texture(inputTexture, pos);
+    if(pass == PASS_HORIZONTAL) {
+        outColor = blur(vec2(1, 0));
+        return;
     }
-    outColor /= 9.0;
-    outColor *= vec4(1, 1, 1, 0.995);
-    return;
-}
\ No newline at end of file
+
+    vec4 trail = blur(vec2(0, 1));
+    trail.w *= DECAY;
+
+    // Layer the current entities on top of the faded trail:
+    vec4 entities = sample_entities();
+    float alpha = entities.w + (trail.w * (1 - entities.w));
+    outColor = alpha > 0 ? vec4(((entities.xyz * entities.w) + (trail.xyz * trail.w * (1 - entities.w))) / alpha, alpha) : vec4(0);
+}
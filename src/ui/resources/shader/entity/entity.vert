@@ -1,12 +1,18 @@
 #version 450 core
 
-layout(location = 0) in vec4 color;
+uniform vec2 worldSize;
+// Has to match the size of sim::EntityPaletteIndex:
+uniform vec4 palette[3];
+
+// One of sim::EntityPaletteIndex:
+layout(location = 0) in uint paletteIndex;
+// Normalized to [0, 1] relative to the world size:
 layout(location = 1) in vec2 position;
 
 out vec4 gColor;
 
 void main()
 {
-    gColor = color;
-    gl_Position = vec4(position, 0.0, 1.0);
+    gColor = palette[min(paletteIndex, 2)];
+    gl_Position = vec4(position * worldSize, 0.0, 1.0);
 }
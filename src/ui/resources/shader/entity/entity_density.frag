@@ -0,0 +1,9 @@
+#version 450 core
+
+out vec4 outColor;
+
+void main()
+{
+    // Gets summed up per cell by additive blending:
+    outColor = vec4(1.0, 0.0, 0.0, 0.0);
+}
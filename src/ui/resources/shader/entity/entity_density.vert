@@ -0,0 +1,15 @@
+#version 450 core
+
+// Transforms normalized map positions to normalized device coordinates, see opengl::Camera:
+layout(std140, binding = 1) uniform cameraBlock {
+    mat4 viewMatrix;
+};
+
+// Normalized to [0, 1] relative to the world size:
+layout(location = 1) in vec2 position;
+
+void main()
+{
+    // Drawn as a single pixel point, so every entity lands in exactly one heatmap cell:
+    gl_Position = viewMatrix * vec4(position, 0.0, 1.0);
+}
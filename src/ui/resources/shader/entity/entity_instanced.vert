@@ -0,0 +1,29 @@
+#version 450 core
+
+uniform vec2 worldSize;
+uniform vec2 rectSize;
+// Has to match the size of sim::EntityPaletteIndex:
+uniform vec4 palette[3];
+// Transforms normalized map positions to normalized device coordinates, see opengl::Camera:
+layout(std140, binding = 1) uniform cameraBlock {
+    mat4 viewMatrix;
+};
+
+// Per instance, one of sim::EntityPaletteIndex:
+layout(location = 0) in uint paletteIndex;
+// Per instance, normalized to [0, 1] relative to the world size:
+layout(location = 1) in vec2 position;
+
+out vec4 fColor;
+
+// Corners of the triangle strip building the rect, selected by gl_VertexID:
+const vec2 CORNERS[4] = vec2[4](vec2(-1, -1), vec2(1, -1), vec2(-1, 1), vec2(1, 1));
+
+void main()
+{
+    fColor = palette[min(paletteIndex, 2)];
+
+    // Same rect size as the one build by entity.geom:
+    vec2 worldPos = (position * worldSize) + (CORNERS[gl_VertexID] * (rectSize / 4));
+    gl_Position = viewMatrix * vec4(worldPos / worldSize, 0.0, 1.0);
+}
@@ -0,0 +1,30 @@
+#version 450 core
+
+uniform vec2 worldSize;
+uniform vec2 rectSize;
+// Size of the current viewport in pixels:
+uniform vec2 viewportSize;
+// Has to match the size of sim::EntityPaletteIndex:
+uniform vec4 palette[3];
+// Transforms normalized map positions to normalized device coordinates, see opengl::Camera:
+layout(std140, binding = 1) uniform cameraBlock {
+    mat4 viewMatrix;
+};
+
+// One of sim::EntityPaletteIndex:
+layout(location = 0) in uint paletteIndex;
+// Normalized to [0, 1] relative to the world size:
+layout(location = 1) in vec2 position;
+
+out vec4 fColor;
+
+void main()
+{
+    fColor = palette[min(paletteIndex, 2)];
+    gl_Position = viewMatrix * vec4(position, 0.0, 1.0);
+
+    // Points are always square, so use the larger side of the rect build by entity.geom:
+    vec2 ndcSize = ((rectSize / 2) / worldSize) * vec2(viewMatrix[0][0], viewMatrix[1][1]);
+    vec2 pixelSize = (ndcSize / 2) * viewportSize;
+    gl_PointSize = max(max(pixelSize.x, pixelSize.y), 1.0);
+}
@@ -0,0 +1,40 @@
+#version 450 core
+
+in vec2 fTexCoordinates;
+
+// Number of entities per cell:
+uniform sampler2D densityTexture;
+// Number of entities per cell that maps to the hottest color:
+uniform float saturationCount;
+
+out vec4 outColor;
+
+const int STOP_COUNT = 5;
+const vec3 STOPS[STOP_COUNT] = vec3[](
+    vec3(0.0, 0.0, 1.0),
+    vec3(0.0, 1.0, 1.0),
+    vec3(0.0, 1.0, 0.0),
+    vec3(1.0, 1.0, 0.0),
+    vec3(1.0, 0.0, 0.0)
+);
+
+vec3 color_map(float t)
+{
+    float pos = t * (STOP_COUNT - 1);
+    int index = min(int(pos), STOP_COUNT - 2);
+    return mix(STOPS[index], STOPS[index + 1], pos - index);
+}
+
+void main()
+{
+    float count = texture(densityTexture, fTexCoordinates).r;
+    if(count <= 0) {
+        // Keep the map visible where there are no entities:
+        outColor = vec4(0);
+        return;
+    }
+
+    // Densities span several orders of magnitude, so map them logarithmically:
+    float t = clamp(log(1 + count) / log(1 + saturationCount), 0, 1);
+    outColor = vec4(color_map(t), 0.5 + (t * 0.5));
+}
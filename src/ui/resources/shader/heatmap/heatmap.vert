@@ -0,0 +1,3 @@
+#version 450 core
+
+void main() { }
\ No newline at end of file
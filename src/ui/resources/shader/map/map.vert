@@ -1,16 +1,19 @@
 #version 450 core
 
 uniform vec2 worldSize;
+// Transforms normalized map positions to normalized device coordinates, see opengl::Camera:
+layout(std140, binding = 1) uniform cameraBlock {
+    mat4 viewMatrix;
+};
 
-layout(location = 0) in vec4 color;
-layout(location = 1) in vec2 position;
+// Two vertices (start and end) of the selected road:
+layout(location = 0) in vec2 position;
 
 out vec4 fColor;
 
-void main(void) {
-    // Normalize to range [-1, 1]:
-    vec2 pos = ((position / worldSize) * 2) - 1;
+const vec4 SELECTED_COLOR = vec4(0.0, 1.0, 0.0, 1.0);
 
-    gl_Position = vec4(pos, 0.0, 1.0);
-    fColor = color;
+void main(void) {
+    gl_Position = viewMatrix * vec4(position / worldSize, 0.0, 1.0);
+    fColor = SELECTED_COLOR;
 }
@@ -0,0 +1,13 @@
+#version 450 core
+
+// Two vertices (start and end) per road, already transformed to the tile local range [-1, 1]:
+layout(location = 0) in vec2 position;
+
+out vec4 fColor;
+
+const vec4 ROAD_COLOR = vec4(1.0, 0.0, 0.0, 1.0);
+
+void main(void) {
+    gl_Position = vec4(position, 0.0, 1.0);
+    fColor = ROAD_COLOR;
+}
@@ -0,0 +1,12 @@
+#version 450 core
+
+in vec2 fTexCoordinates;
+
+out vec4 outColor;
+
+uniform sampler2D atlasTexture;
+
+void main()
+{
+    outColor = texture(atlasTexture, fTexCoordinates);
+}
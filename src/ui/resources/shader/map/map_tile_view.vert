@@ -0,0 +1,22 @@
+#version 450 core
+
+// Transforms normalized map positions to normalized device coordinates, see opengl::Camera:
+layout(std140, binding = 1) uniform cameraBlock {
+    mat4 viewMatrix;
+};
+
+// minX, minY, maxX, maxY in normalized map coordinates:
+layout(location = 0) in vec4 mapRect;
+// minX, minY, maxX, maxY inside the tile atlas:
+layout(location = 1) in vec4 atlasRect;
+
+out vec4 gAtlasRect;
+
+void main()
+{
+    gAtlasRect = atlasRect;
+    // The camera only scales and translates, so the rect stays axis aligned:
+    vec2 screenMin = (viewMatrix * vec4(mapRect.xy, 0.0, 1.0)).xy;
+    vec2 screenMax = (viewMatrix * vec4(mapRect.zw, 0.0, 1.0)).xy;
+    gl_Position = vec4(screenMin, screenMax);
+}
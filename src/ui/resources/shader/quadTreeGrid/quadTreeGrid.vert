@@ -1,12 +1,78 @@
 #version 450 core
 
 uniform vec2 worldSize;
+// Has to match sim::QUAD_TREE_MAX_DEPTH:
+uniform uint maxDepth;
+// Transforms normalized map positions to normalized device coordinates, see opengl::Camera:
+layout(std140, binding = 1) uniform cameraBlock {
+    mat4 viewMatrix;
+};
 
-layout(location = 1) in vec2 position;
+// Has to match sim::gpu_quad_tree::Node:
+struct QuadTreeNodeDescriptor {
+    int acquireLock;
+    int writeLock;
+    int readerLock;
+
+    float offsetX;
+    float offsetY;
+    float width;
+    float height;
+
+    uint contentType;
+    uint entityCount;
+    uint first;
+
+    uint prevNodeIndex;
+
+    uint nextTL;
+    uint nextTR;
+    uint nextBL;
+    uint nextBR;
+
+    uint padding;
+};
+
+layout(std430, binding = 0) readonly buffer bufQuadTreeNodes { QuadTreeNodeDescriptor quadTreeNodes[]; };
+
+// sim::gpu_quad_tree::NextType::NODE:
+const uint TYPE_NODE = 1;
+
+// Four lines building the outline of a node, selected by gl_VertexID:
+const vec2 OUTLINE[8] = vec2[8](vec2(0, 0), vec2(1, 0),
+                                vec2(1, 0), vec2(1, 1),
+                                vec2(1, 1), vec2(0, 1),
+                                vec2(0, 1), vec2(0, 0));
+
+/**
+ * Nodes get allocated from a pool and keep their old content once they are freed.
+ * So only nodes that are linked all the way up to the root (the node pointing to itself) are part of the tree.
+ **/
+bool is_in_tree(uint nodeIndex) {
+    for (uint depth = 0; depth <= maxDepth; depth++) {
+        uint prevNodeIndex = quadTreeNodes[nodeIndex].prevNodeIndex;
+        if (prevNodeIndex == nodeIndex) {
+            return nodeIndex == 0;
+        }
+
+        QuadTreeNodeDescriptor prev = quadTreeNodes[prevNodeIndex];
+        if (prev.contentType != TYPE_NODE || (prev.nextTL != nodeIndex && prev.nextTR != nodeIndex && prev.nextBL != nodeIndex && prev.nextBR != nodeIndex)) {
+            return false;
+        }
+        nodeIndex = prevNodeIndex;
+    }
+    return false;
+}
 
 void main(void) {
-    // Normalize to range [-1, 1]:
-    vec2 pos = ((position / worldSize) * 2) - 1;
+    uint nodeIndex = uint(gl_InstanceID);
+    if (!is_in_tree(nodeIndex)) {
+        // Move both ends outside of the clip volume, so the line gets discarded:
+        gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+        return;
+    }
 
-    gl_Position = vec4(pos, 0.0, 1.0);
+    QuadTreeNodeDescriptor node = quadTreeNodes[nodeIndex];
+    vec2 position = vec2(node.offsetX, node.offsetY) + (OUTLINE[gl_VertexID] * vec2(node.width, node.height));
+    gl_Position = viewMatrix * vec4(position / worldSize, 0.0, 1.0);
 }
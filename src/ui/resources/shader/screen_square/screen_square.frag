@@ -4,41 +4,30 @@ in vec2 fTexCoordinates;
 
 out vec4 outColor;
 
-uniform sampler2D mapTexture;
 uniform sampler2D entitiesTexture;
 uniform sampler2D quadTreeGridTexture;
-uniform vec2 textureSize;
-uniform vec2 screenSize;
+uniform sampler2D trailTexture;
 uniform uint quadTreeGridVisible;
+uniform uint trailVisible;
 
 void main()
 {
-    float textureAspectRatio = textureSize.x / textureSize.y;
-    float screenAspectRatio = screenSize.x / screenSize.y;
-    float textureScreenRatio = textureAspectRatio / screenAspectRatio;
-    float scaleX = 1.0;
-    float scaleY = 1.0;
+    // The frame buffers cover the whole screen and are already transformed by the camera:
+    vec4 texEntitiesColor = texture(entitiesTexture, fTexCoordinates);
 
-    if(screenAspectRatio < 1.0) {
-        scaleY = textureScreenRatio;
-    }
-    else {
-        scaleX = 1.0 / textureScreenRatio;
-    }
+    // Layer textures with premultiplied alpha, the map tiles below get blended in by the fixed function blending:
+    outColor = vec4(texEntitiesColor.xyz * texEntitiesColor.w, texEntitiesColor.w);
 
-    // Get texture coordinates and colors:
-    vec2 scaledCoords = fTexCoordinates * vec2(scaleX, scaleY);
-    vec4 texMapColor = texture(mapTexture, scaledCoords);
-    vec4 texEntitiesColor = texture(entitiesTexture, scaledCoords);
-
-    // Layer textures:
-    outColor =  texMapColor * (1 - texEntitiesColor.w);
-    outColor += texEntitiesColor * texEntitiesColor.w;
+    // The downsampled trails go below the entities and get interpolated while magnifying:
+    if(trailVisible != 0) {
+        vec4 texTrailColor = texture(trailTexture, fTexCoordinates);
+        outColor += vec4(texTrailColor.xyz * texTrailColor.w, texTrailColor.w) * (1 - outColor.w);
+    }
 
     if(quadTreeGridVisible != 0) {
-        vec4 texQuadTreeGridColor = texture(quadTreeGridTexture, scaledCoords);
+        vec4 texQuadTreeGridColor = texture(quadTreeGridTexture, fTexCoordinates);
         outColor *= (1 - texQuadTreeGridColor.w);
-        outColor += texQuadTreeGridColor * texQuadTreeGridColor.w;
+        outColor += vec4(texQuadTreeGridColor.xyz * texQuadTreeGridColor.w, texQuadTreeGridColor.w);
     }
     return;
-}
\ No newline at end of file
+}
@@ -42,6 +42,7 @@ void SimulationOverlayWidget::draw_text(const std::string& text, const Cairo::Re
 
 void SimulationOverlayWidget::set_debug_overlay_enabled(bool enableDebugOverlay) {
     this->enableDebugOverlay = enableDebugOverlay;
+    queue_draw();
 }
 
 //-----------------------------Events:-----------------------------
@@ -61,15 +62,15 @@ void SimulationOverlayWidget::on_draw_handler(const Cairo::RefPtr<Cairo::Context
     double fps = simWidget->get_fps().get_ticks();
     std::string fpsTime = simWidget->get_fps_history().get_avg_time_str();
 
-    std::locale local("en_US.UTF-8");
     std::string stats = fmt::format("TPS: {:.2f}\nTick Time: {} (Update: {}, Collision: {})\n", tps, tpsTime, updateTickTime, collisionDetectionTickTime);
     stats += fmt::format("FPS: {:.2f}\nFrame Time: {}\n", fps, fpsTime);
-    stats += fmt::format(local, "Entities: {:L}\n", sim::MAX_ENTITIES);
+    stats += fmt::format(locale, "Entities: {:L}\n", sim::MAX_ENTITIES);
+    stats += fmt::format("Collision Backend: {}\n", sim::to_string(simulator->get_collision_backend()));
     stats += fmt::format("Zoom: {}\n", simWidget->get_zoom_factor());
-    stats += fmt::format(local, "\nMap Size: {:L}x{:L}\n", simulator->get_map()->width, simulator->get_map()->height);
-    stats += fmt::format(local, "Roads: {:L}\n", simulator->get_map()->roads.size());
-    stats += fmt::format(local, "Connections: {:L}\n", simulator->get_map()->connections.size());
-    stats += fmt::format(local, "Render Resolution: {:L}x{:L}\n", sim::MAX_RENDER_RESOLUTION_X, sim::MAX_RENDER_RESOLUTION_Y);
+    stats += fmt::format(locale, "\nMap Size: {:L}x{:L}\n", simulator->get_map()->width, simulator->get_map()->height);
+    stats += fmt::format(locale, "Roads: {:L}\n", simulator->get_map()->roads.size());
+    stats += fmt::format(locale, "Connections: {:L}\n", simulator->get_map()->connections.size());
+    stats += fmt::format(locale, "Render Resolution: {:L}x{:L}\n", simWidget->get_render_width(), simWidget->get_render_height());
 
     assert(simulator);
     const std::shared_ptr<sim::Map> map = simulator->get_map();
@@ -85,13 +86,13 @@ void SimulationOverlayWidget::on_draw_handler(const Cairo::RefPtr<Cairo::Context
         uint startIndex = map->roads[*(map->selectedRoad)].start.connectedIndex;
         uint endIndex = map->roads[*(map->selectedRoad)].end.connectedIndex;
         stats += "\n";
-        stats += fmt::format("Selected road: {}\n", selectedRoad);
+        stats += fmt::format("Selected road: {}\n", map->roadIds[selectedRoad]);
         stats += fmt::format("Start pos: ({}|{})\n", startX, startY);
         stats += fmt::format("Start index: {}\n", startIndex);
         stats += fmt::format("Start connection count: {}\n", connectedCountStart);
         stats += fmt::format("Start connections: ", connectedCountStart);
         for (size_t i = 0; i < connectedCountStart; i++) {
-            stats += std::to_string(map->connections[selectedRoad + i]) + " ";
+            stats += std::to_string(map->roadIds[map->connections[startIndex + i]]) + " ";
         }
         stats += "\n";
         stats += fmt::format("End pos: ({}|{})\n", endX, endY);
@@ -99,7 +100,7 @@ void SimulationOverlayWidget::on_draw_handler(const Cairo::RefPtr<Cairo::Context
         stats += fmt::format("End connection count: {}\n", connectedCountEnd);
         stats += fmt::format("End connections: ", connectedCountEnd);
         for (size_t i = 0; i < connectedCountEnd; i++) {
-            stats += std::to_string(map->connections[selectedRoad + i]) + " ";
+            stats += std::to_string(map->roadIds[map->connections[endIndex + i]]) + " ";
         }
         stats += "\n";
     }
@@ -108,7 +109,14 @@ void SimulationOverlayWidget::on_draw_handler(const Cairo::RefPtr<Cairo::Context
 
 bool SimulationOverlayWidget::on_tick(const Glib::RefPtr<Gdk::FrameClock>& /*frameClock*/) {
     assert(simulator);
-    queue_draw();
+    assert(simWidget);
+
+    // Laying out the text is expensive, so only redraw once any of the shown values changed:
+    const std::array<uint64_t, 3> generations{simulator->get_tick_generation(), simWidget->get_view_generation(), simulator->get_map()->selectionGeneration};
+    if (enableDebugOverlay && generations != drawnGenerations) {
+        drawnGenerations = generations;
+        queue_draw();
+    }
     return true;
 }
 }  // namespace ui::widgets
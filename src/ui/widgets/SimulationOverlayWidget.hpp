@@ -2,6 +2,9 @@
 
 #include "SimulationWidget.hpp"
 #include "sim/Simulator.hpp"
+#include <array>
+#include <cstdint>
+#include <locale>
 #include <memory>
 #include <gtkmm.h>
 
@@ -11,6 +14,15 @@ class SimulationOverlayWidget : public Gtk::DrawingArea {
     std::shared_ptr<sim::Simulator> simulator{nullptr};
     SimulationWidget* simWidget{nullptr};
     bool enableDebugOverlay{true};
+    /**
+     * Used for grouping digits. Constructing it is expensive, so it only happens once.
+     **/
+    std::locale locale{"en_US.UTF-8"};
+    /**
+     * Tick, view and selection generation the overlay got last drawn for.
+     * The overlay only gets redrawn once one of them changes.
+     **/
+    std::array<uint64_t, 3> drawnGenerations{};
 
  public:
     explicit SimulationOverlayWidget(SimulationWidget* simWidget);
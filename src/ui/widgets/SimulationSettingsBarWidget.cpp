@@ -1,6 +1,7 @@
 #include "SimulationSettingsBarWidget.hpp"
 #include "sim/Simulator.hpp"
 #include "ui/widgets/SimulationWidget.hpp"
+#include <bit>
 #include <cassert>
 #include <gdkmm/display.h>
 #include <gdkmm/pixbuf.h>
@@ -8,6 +9,7 @@
 #include <gtkmm/enums.h>
 #include <gtkmm/icontheme.h>
 #include <gtkmm/image.h>
+#include <gtkmm/stringlist.h>
 
 namespace ui::widgets {
 SimulationSettingsBarWidget::SimulationSettingsBarWidget(SimulationWidget* simWidget, SimulationOverlayWidget* simOverlayWidget) : Gtk::Box(Gtk::Orientation::HORIZONTAL),
@@ -58,7 +60,6 @@ void SimulationSettingsBarWidget::prep_widget() {
     zoomInBtn.signal_clicked().connect(sigc::mem_fun(*this, &SimulationSettingsBarWidget::on_zoom_in_clicked));
     zoomInBtn.set_tooltip_text("Zoom in");
     zoomInBtn.set_icon_name("zoom-in");
-    zoomInBtn.set_sensitive(false);
     zoomBox.append(zoomInBtn);
 
     zoomOutBtn.signal_clicked().connect(sigc::mem_fun(*this, &SimulationSettingsBarWidget::on_zoom_out_clicked));
@@ -81,10 +82,24 @@ void SimulationSettingsBarWidget::prep_widget() {
     blurTBtn.set_tooltip_text("Blur entities");
     miscBox.append(blurTBtn);
 
+    // Entry i downsamples the trails by 2^i:
+    trailResolutionDropDown.set_model(Gtk::StringList::create({"Full", "1/2", "1/4", "1/8"}));
+    trailResolutionDropDown.set_selected(static_cast<guint>(std::countr_zero(static_cast<unsigned int>(simWidget->get_trail_downsampling()))));
+    trailResolutionDropDown.property_selected().signal_changed().connect(sigc::mem_fun(*this, &SimulationSettingsBarWidget::on_trail_resolution_selected));
+    trailResolutionDropDown.set_tooltip_text("Trail resolution");
+    miscBox.append(trailResolutionDropDown);
+
     quadTreeGridTBtn.property_active().signal_changed().connect(sigc::mem_fun(*this, &SimulationSettingsBarWidget::on_quad_tree_grid_toggled));
     quadTreeGridTBtn.set_icon_name("transparent-background-symbolic");
     quadTreeGridTBtn.set_tooltip_text("Toggle Quad Tree Grid");
     miscBox.append(quadTreeGridTBtn);
+
+    // Has to be in the same order as opengl::EntityRenderMode:
+    entityRenderModeDropDown.set_model(Gtk::StringList::create({"Geometry Shader", "Instanced", "Point Sprites"}));
+    entityRenderModeDropDown.set_selected(static_cast<guint>(simWidget->get_entity_render_mode()));
+    entityRenderModeDropDown.property_selected().signal_changed().connect(sigc::mem_fun(*this, &SimulationSettingsBarWidget::on_entity_render_mode_selected));
+    entityRenderModeDropDown.set_tooltip_text("Entity render mode");
+    miscBox.append(entityRenderModeDropDown);
 }
 
 //-----------------------------Events:-----------------------------
@@ -109,39 +124,25 @@ void SimulationSettingsBarWidget::on_debug_overlay_toggled() {
     simOverlayWidget->set_debug_overlay_enabled(debugOverlayTBtn.get_active());
 }
 
+// The camera clamps the zoom factor:
 void SimulationSettingsBarWidget::on_zoom_in_clicked() {
     assert(simWidget);
-    float zoomFactor = simWidget->get_zoom_factor();
-    zoomFactor *= 1.25;
-    if (zoomFactor >= 1) {
-        zoomFactor = 1;
-        zoomInBtn.set_sensitive(false);
-    }
-    simWidget->set_zoom_factor(zoomFactor);
+    simWidget->set_zoom_factor(simWidget->get_zoom_factor() * 1.25F);
 }
 
 void SimulationSettingsBarWidget::on_zoom_out_clicked() {
     assert(simWidget);
-    float zoomFactor = simWidget->get_zoom_factor();
-    zoomFactor *= 0.75;
-    zoomInBtn.set_sensitive(true);
-    simWidget->set_zoom_factor(zoomFactor);
+    simWidget->set_zoom_factor(simWidget->get_zoom_factor() * 0.75F);
 }
 
 void SimulationSettingsBarWidget::on_zoom_reset_clicked() {
     assert(simWidget);
     simWidget->set_zoom_factor(1.0);
-    zoomInBtn.set_sensitive(false);
 }
 
 void SimulationSettingsBarWidget::on_zoom_fit_clicked() {
     assert(simWidget);
-    float zoomFactor = simWidget->get_zoom_factor();
-    float zoomX = static_cast<float>(simWidget->get_width()) / sim::MAX_RENDER_RESOLUTION_X;
-    float zoomY = static_cast<float>(simWidget->get_height()) / sim::MAX_RENDER_RESOLUTION_Y;
-    zoomFactor = zoomX > zoomY ? zoomY : zoomX;
-    simWidget->set_zoom_factor(zoomFactor);
-    zoomInBtn.set_sensitive(true);
+    simWidget->zoom_fit();
 }
 
 void SimulationSettingsBarWidget::on_blur_toggled() {
@@ -149,8 +150,18 @@ void SimulationSettingsBarWidget::on_blur_toggled() {
     simWidget->set_blur(blurTBtn.get_active());
 }
 
+void SimulationSettingsBarWidget::on_trail_resolution_selected() {
+    assert(simWidget);
+    simWidget->set_trail_downsampling(static_cast<GLsizei>(1U << trailResolutionDropDown.get_selected()));
+}
+
 void SimulationSettingsBarWidget::on_quad_tree_grid_toggled() {
     assert(simWidget);
     simWidget->set_quad_tree_grid_visibility(quadTreeGridTBtn.get_active());
 }
+
+void SimulationSettingsBarWidget::on_entity_render_mode_selected() {
+    assert(simWidget);
+    simWidget->set_entity_render_mode(static_cast<opengl::EntityRenderMode>(entityRenderModeDropDown.get_selected()));
+}
 }  // namespace ui::widgets
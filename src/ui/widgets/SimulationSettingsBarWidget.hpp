@@ -6,6 +6,7 @@
 #include "ui/widgets/SimulationOverlayWidget.hpp"
 #include <memory>
 #include <gtkmm/box.h>
+#include <gtkmm/dropdown.h>
 #include <gtkmm/switch.h>
 #include <gtkmm/togglebutton.h>
 
@@ -29,7 +30,9 @@ class SimulationSettingsBarWidget : public Gtk::Box {
     Gtk::Button zoomFitBtn;
 
     Gtk::ToggleButton blurTBtn;
+    Gtk::DropDown trailResolutionDropDown;
     Gtk::ToggleButton quadTreeGridTBtn;
+    Gtk::DropDown entityRenderModeDropDown;
 
     std::shared_ptr<sim::Simulator> simulator{nullptr};
 
@@ -48,6 +51,8 @@ class SimulationSettingsBarWidget : public Gtk::Box {
     void on_zoom_reset_clicked();
     void on_zoom_fit_clicked();
     void on_blur_toggled();
+    void on_trail_resolution_selected();
     void on_quad_tree_grid_toggled();
+    void on_entity_render_mode_selected();
 };
 }  // namespace ui::widgets
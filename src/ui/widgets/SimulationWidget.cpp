@@ -1,45 +1,57 @@
 #include "SimulationWidget.hpp"
 #include "logger/Logger.hpp"
 #include "sim/Entity.hpp"
+#include "sim/GlInterop.hpp"
 #include "sim/Map.hpp"
 #include "sim/Simulator.hpp"
 #include "spdlog/fmt/bundled/core.h"
 #include "spdlog/spdlog.h"
-#include "ui/widgets/opengl/fb/MapFrameBuffer.hpp"
+#include "ui/widgets/opengl/Camera.hpp"
+#include "ui/widgets/opengl/MapTileCache.hpp"
+#include "ui/widgets/opengl/fb/HeatmapFrameBuffer.hpp"
+#include "ui/widgets/opengl/fb/MapTileAtlasFrameBuffer.hpp"
 #include "ui/widgets/opengl/fb/QuadTreeGridFrameBuffer.hpp"
+#include "ui/widgets/opengl/fb/TrailFrameBuffer.hpp"
+#include "ui/widgets/opengl/utils/Utils.hpp"
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <chrono>
 #include <cmath>
 #include <cstddef>
-#include <limits>
+#include <optional>
 #include <string>
+#include <vector>
 #include <bits/chrono.h>
 #include <epoxy/gl.h>
 #include <epoxy/gl_generated.h>
 #include <fmt/core.h>
 #include <glibconfig.h>
+#include <gtkmm/eventcontrollermotion.h>
+#include <gtkmm/eventcontrollerscroll.h>
 #include <gtkmm/gestureclick.h>
+#include <gtkmm/gesturedrag.h>
 #include <gtkmm/gesturezoom.h>
+#include <unistd.h>
 
 namespace ui::widgets {
+// The entities, quad tree grid, trail and heatmap frame buffers get resized to the GL area on the first frame:
 SimulationWidget::SimulationWidget() : simulator(sim::Simulator::get_instance()),
-                                       mapFrameBuffer(sim::MAX_RENDER_RESOLUTION_X, sim::MAX_RENDER_RESOLUTION_Y),
-                                       entitiesFrameBuffer(sim::MAX_RENDER_RESOLUTION_X, sim::MAX_RENDER_RESOLUTION_Y),
-                                       quadTreeGridFrameBuffer(sim::MAX_RENDER_RESOLUTION_X, sim::MAX_RENDER_RESOLUTION_Y) {
+                                       mapTileAtlasFrameBuffer(opengl::tiles::ATLAS_SIZE_X, opengl::tiles::ATLAS_SIZE_Y),
+                                       entitiesFrameBuffer(1, 1),
+                                       quadTreeGridFrameBuffer(1, 1),
+                                       trailFrameBuffer(1, 1),
+                                       trailScratchFrameBuffer(1, 1),
+                                       heatmapFrameBuffer(1, 1) {
     prep_widget();
 }
 
 void SimulationWidget::set_zoom_factor(float zoomFactor) {
     assert(zoomFactor > 0);
 
-    this->zoomFactor = zoomFactor;
-    float widthF = static_cast<float>(sim::MAX_RENDER_RESOLUTION_X) * this->zoomFactor;
-    int width = static_cast<int>(widthF);
-    float heightF = static_cast<float>(sim::MAX_RENDER_RESOLUTION_Y) * this->zoomFactor;
-    int height = static_cast<int>(heightF);
-    glArea.set_size_request(width, height);
-    glArea.queue_draw();
+    camera.set_zoom_factor(zoomFactor);
+    cameraChanged = true;
+    queue_view_update();
 }
 
 void SimulationWidget::prep_widget() {
@@ -54,14 +66,29 @@ void SimulationWidget::prep_widget() {
     clickGesture->signal_pressed().connect(sigc::mem_fun(*this, &SimulationWidget::on_glArea_clicked));
     glArea.add_controller(clickGesture);
 
+    // Pan with any but the primary button, which selects roads:
+    dragGesture = Gtk::GestureDrag::create();
+    dragGesture->set_button(0);
+    dragGesture->signal_drag_begin().connect(sigc::mem_fun(*this, &SimulationWidget::on_drag_begin));
+    dragGesture->signal_drag_update().connect(sigc::mem_fun(*this, &SimulationWidget::on_drag_update));
+    glArea.add_controller(dragGesture);
+
+    // Zoom towards the pointer:
+    Glib::RefPtr<Gtk::EventControllerScroll> scrollController = Gtk::EventControllerScroll::create();
+    scrollController->set_flags(Gtk::EventControllerScroll::Flags::VERTICAL);
+    scrollController->signal_scroll().connect(sigc::mem_fun(*this, &SimulationWidget::on_scroll), false);
+    glArea.add_controller(scrollController);
+    Glib::RefPtr<Gtk::EventControllerMotion> motionController = Gtk::EventControllerMotion::create();
+    motionController->signal_motion().connect(sigc::mem_fun(*this, &SimulationWidget::on_pointer_motion));
+    glArea.add_controller(motionController);
+
     assert(simulator);
     const std::shared_ptr<sim::Map> map = simulator->get_map();
     assert(map);
 
     glArea.set_auto_render();
-    glArea.set_size_request(sim::MAX_RENDER_RESOLUTION_X, sim::MAX_RENDER_RESOLUTION_Y);
-    set_child(glArea);
-    screenSquareObj.set_glArea(&glArea);
+    glArea.set_expand();
+    append(glArea);
 }
 
 const utils::TickRate& SimulationWidget::get_fps() const {
@@ -73,16 +100,156 @@ const utils::TickDurationHistory& SimulationWidget::get_fps_history() const {
 }
 
 float SimulationWidget::get_zoom_factor() const {
-    return zoomFactor;
+    return camera.get_zoom_factor();
+}
+
+void SimulationWidget::zoom_fit() {
+    const float width = static_cast<float>(glArea.get_width());
+    const float height = static_cast<float>(glArea.get_height());
+    camera.set_center({0.5F, 0.5F});
+    set_zoom_factor(std::max(std::min(width, height), 1.0F) / opengl::CAMERA_MAP_PIXELS);
+}
+
+GLsizei SimulationWidget::get_render_width() const {
+    return entitiesFrameBuffer.get_texture_size_x();
+}
+
+GLsizei SimulationWidget::get_render_height() const {
+    return entitiesFrameBuffer.get_texture_size_y();
 }
 
 void SimulationWidget::set_blur(bool blur) {
     this->blur = blur;
+    trailsOutdated = true;
+    queue_view_update();
+}
+
+void SimulationWidget::set_trail_downsampling(GLsizei downsampling) {
+    assert(downsampling > 0);
+    blurObject.set_downsampling(downsampling);
+    // The trail frame buffers get reallocated on the next frame:
+    queue_view_update();
+}
+
+GLsizei SimulationWidget::get_trail_downsampling() const {
+    return blurObject.get_downsampling();
+}
+
+void SimulationWidget::set_heatmap_zoom_threshold(float heatmapZoomThreshold) {
+    assert(heatmapZoomThreshold >= 0);
+    this->heatmapZoomThreshold = heatmapZoomThreshold;
+    cameraChanged = true;
+    queue_view_update();
+}
+
+float SimulationWidget::get_heatmap_zoom_threshold() const {
+    return heatmapZoomThreshold;
+}
+
+bool SimulationWidget::is_heatmap_active() const {
+    return camera.get_zoom_factor() < heatmapZoomThreshold;
+}
+
+float SimulationWidget::calc_heatmap_saturation_count() const {
+    // Keep colors stable while zooming by relating counts to entities spread evenly across the whole map:
+    const float cellShare = static_cast<float>(opengl::HEATMAP_CELL_PIXELS) / camera.get_map_pixels();
+    const float evenCount = static_cast<float>(sim::MAX_ENTITIES) * cellShare * cellShare;
+    return std::max(evenCount * opengl::HEATMAP_SATURATION_FACTOR, 1.0F);
+}
+
+void SimulationWidget::set_entity_render_mode(opengl::EntityRenderMode entityRenderMode) {
+    entityObj.set_render_mode(entityRenderMode);
+    cameraChanged = true;
+    queue_view_update();
+}
+
+opengl::EntityRenderMode SimulationWidget::get_entity_render_mode() const {
+    return entityObj.get_render_mode();
 }
 
 void SimulationWidget::set_quad_tree_grid_visibility(bool quadTreeGridVisible) {
     this->quadTreeGridVisible = quadTreeGridVisible;
     screenSquareObj.set_quad_tree_grid_visibility(quadTreeGridVisible);
+    cameraChanged = true;
+    queue_view_update();
+}
+
+uint64_t SimulationWidget::get_view_generation() const {
+    return viewGeneration;
+}
+
+void SimulationWidget::queue_view_update() {
+    viewGeneration++;
+    glArea.queue_draw();
+}
+
+bool SimulationWidget::resize_frame_buffers(GLsizei width, GLsizei height) {
+    width = std::max(width, 1);
+    height = std::max(height, 1);
+    bool resized = entitiesFrameBuffer.resize(width, height);
+    quadTreeGridFrameBuffer.resize(width, height);
+
+    // Round up, so the trails cover the whole screen:
+    const GLsizei downsampling = blurObject.get_downsampling();
+    const GLsizei trailWidth = (width + downsampling - 1) / downsampling;
+    const GLsizei trailHeight = (height + downsampling - 1) / downsampling;
+    heatmapFrameBuffer.resize((width + opengl::HEATMAP_CELL_PIXELS - 1) / opengl::HEATMAP_CELL_PIXELS, (height + opengl::HEATMAP_CELL_PIXELS - 1) / opengl::HEATMAP_CELL_PIXELS);
+    if (trailFrameBuffer.resize(trailWidth, trailHeight)) {
+        trailScratchFrameBuffer.resize(trailWidth, trailHeight);
+        resized = true;
+    }
+    if (!resized) {
+        return false;
+    }
+
+    // Textures got recreated:
+    trailsOutdated = true;
+    viewGeneration++;
+    blurObject.bind_entities_texture(entitiesFrameBuffer.get_texture());
+    heatmapObj.bind_texture(heatmapFrameBuffer.get_texture());
+    screenSquareObj.bind_texture(entitiesFrameBuffer.get_texture(), quadTreeGridFrameBuffer.get_texture(), trailFrameBuffer.get_texture());
+    return true;
+}
+
+void SimulationWidget::update_camera_uniform() const {
+    const std::array<float, 16> viewMatrix = camera.calc_view_matrix();
+    glBindBuffer(GL_UNIFORM_BUFFER, cameraUbo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(viewMatrix), viewMatrix.data());
+    GLERR;
+}
+
+bool SimulationWidget::import_shared_buffer_sync() {
+    std::optional<sim::gl_interop::SharedBufferSyncHandle> handle = simulator->export_shared_buffer_sync();
+    if (!handle) {
+        return false;
+    }
+    // Takes ownership of both file descriptors, even in case the first import fails:
+    const bool readyImported = opengl::utils::import_shared_semaphore(handle->readyFd, sharedReadySemaphore);
+    if (!readyImported) {
+        close(handle->releasedFd);
+        return false;
+    }
+    return opengl::utils::import_shared_semaphore(handle->releasedFd, sharedReleasedSemaphore);
+}
+
+void SimulationWidget::copy_shared_entities() {
+    std::vector<GLuint> sharedBuffers{entityObj.get_shared_vbo()};
+    if (sharedQuadTreeNodes) {
+        sharedBuffers.push_back(quadTreeGridGlObj.get_shared_nodes());
+    }
+
+    // Vulkan released the buffers to the external queue family, so there are no layouts to transition:
+    glWaitSemaphoreEXT(sharedReadySemaphore, static_cast<GLuint>(sharedBuffers.size()), sharedBuffers.data(), 0, nullptr, nullptr);
+    entityObj.copy_shared_entities();
+    if (sharedQuadTreeNodes) {
+        quadTreeGridGlObj.copy_shared_quad_tree_nodes();
+    }
+    glSignalSemaphoreEXT(sharedReleasedSemaphore, static_cast<GLuint>(sharedBuffers.size()), sharedBuffers.data(), 0, nullptr, nullptr);
+
+    // The simulation submits its wait for the released semaphore once we hand the buffers back, so the signal has to be submitted first:
+    glFlush();
+    simulator->release_shared_entities();
+    GLERR;
 }
 
 //-----------------------------Events:-----------------------------
@@ -93,23 +260,32 @@ bool SimulationWidget::on_render_handler(const Glib::RefPtr<Gdk::GLContext>& /*c
 
     try {
         glArea.throw_if_error();
+        drawnSelectionGeneration = simulator->get_map()->selectionGeneration;
 
         // Update the data on the GPU:
         bool entitiesChanged = false;
-        if (enableUiUpdates) {
-            std::shared_ptr<std::vector<sim::Entity>> entities = simulator->get_entities();
+        if (sharedEntities) {
+            if (enableUiUpdates && simulator->acquire_shared_entities()) {
+                copy_shared_entities();
+                entitiesChanged = true;
+            }
+        } else if (enableUiUpdates) {
+            const utils::Snapshot<std::vector<sim::RenderEntity>>* entities = simulator->get_entities();
             if (entities) {
                 entitiesChanged = true;
-                this->entities = std::move(entities);
+                this->entities = entities;
             }
         }
 
         bool quadTreeNodesChanged = false;
-        if (enableUiUpdates) {
-            std::shared_ptr<std::vector<sim::gpu_quad_tree::Node>> quadTreeNodes = simulator->get_quad_tree_nodes();
+        if (sharedQuadTreeNodes) {
+            quadTreeNodesChanged = entitiesChanged;
+        } else if (enableUiUpdates && quadTreeGridVisible) {
+            // The simulation only reads back the nodes once we took the previous ones:
+            const utils::Snapshot<std::vector<sim::gpu_quad_tree::Node>>* quadTreeNodes = simulator->get_quad_tree_nodes();
             if (quadTreeNodes) {
                 quadTreeNodesChanged = true;
-                this->quadTreeNodes = std::move(quadTreeNodes);
+                this->quadTreeNodes = quadTreeNodes;
             }
         }
 
@@ -120,47 +296,94 @@ bool SimulationWidget::on_render_handler(const Glib::RefPtr<Gdk::GLContext>& /*c
         std::array<int, 4> viewPort{};
         glGetIntegerv(GL_VIEWPORT, viewPort.data());
 
+        // Keep the frame buffers as large as the GL area. The camera works in widget coordinates, the frame buffers in device pixels:
+        if (resize_frame_buffers(viewPort[2], viewPort[3])) {
+            cameraChanged = true;
+        }
+        if (camera.set_viewport_size({static_cast<float>(glArea.get_width()), static_cast<float>(glArea.get_height())})) {
+            cameraChanged = true;
+        }
+        if (cameraChanged) {
+            update_camera_uniform();
+        }
+
         // Draw:
         glDisable(GL_DEPTH_TEST);
 
-        // 1.0 Draw map if needed:
-        if (!mapRendered) {
-            mapRendered = true;
+        // 1.0 Rasterize newly prepared map tiles into the atlas:
+        const std::vector<opengl::tiles::TileUpload> tileUploads = mapTileCache.take_uploads();
+        if (!tileUploads.empty()) {
+            mapTileAtlasFrameBuffer.bind();
+            for (const opengl::tiles::TileUpload& upload : tileUploads) {
+                mapTileRasterObj.set_upload(&upload);
+                mapTileRasterObj.render();
+            }
+            mapTileRasterObj.set_upload(nullptr);
+        }
 
-            mapFrameBuffer.bind();
+        // 1.1 Collect the visible map tiles:
+        mapTileObj.set_quads(mapTileCache.prepare_view(opengl::tiles::calc_tile_view(camera)));
+
+        // 2.0 Draw entities to buffer:
+        if (entitiesChanged || cameraChanged) {
+            entitiesFrameBuffer.bind();
+            // 2.1 Clear old entities, they live on in the trails:
             glClearColor(0, 0, 0, 0);
-            glClear(GL_COLOR_BUFFER_BIT);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
             GLERR;
 
-            mapObj.render();
-        }
+            // 2.2 Draw entities. Shared entities got copied already:
+            if (!sharedEntities && entitiesChanged) {
+                entityObj.set_entities(this->entities->data);
+            }
+            if (is_heatmap_active()) {
+                // Count entities per cell and color the cells instead of drawing overlapping entities:
+                heatmapFrameBuffer.bind();
+                glClearColor(0, 0, 0, 0);
+                glClear(GL_COLOR_BUFFER_BIT);
+                entityObj.render_density();
 
-        // 2.0 Draw entities to buffer:
-        if (entitiesChanged) {
-            entitiesFrameBuffer.bind();
-            // 2.1 Blur old entities:
-            if (blur) {
-                blurObject.render();
+                entitiesFrameBuffer.bind();
+                heatmapObj.set_saturation_count(calc_heatmap_saturation_count());
+                heatmapObj.render();
             } else {
-                glClearColor(0, 0, 0, 0);
-                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-                GLERR;
+                entityObj.render();
             }
 
-            // 2.2 Draw entities:
-            entityObj.set_entities(this->entities);
-            entityObj.render();
+            // 2.3 Update the trails. They live in screen space, so drop them once the camera moves:
+            if (blur) {
+                if (cameraChanged || trailsOutdated) {
+                    trailFrameBuffer.bind();
+                    glClearColor(0, 0, 0, 0);
+                    glClear(GL_COLOR_BUFFER_BIT);
+                    GLERR;
+                    trailsOutdated = false;
+                }
+
+                // Trails only advance with the simulation:
+                if (entitiesChanged) {
+                    trailScratchFrameBuffer.bind();
+                    blurObject.set_pass(opengl::BlurPass::HORIZONTAL, trailFrameBuffer.get_texture());
+                    blurObject.render();
+
+                    trailFrameBuffer.bind();
+                    blurObject.set_pass(opengl::BlurPass::VERTICAL, trailScratchFrameBuffer.get_texture());
+                    blurObject.render();
+                }
+            }
         }
 
         // 3.0 Draw quad tree to buffer:
-        if (quadTreeNodesChanged && quadTreeGridVisible) {
+        if ((quadTreeNodesChanged || cameraChanged) && quadTreeGridVisible) {
             quadTreeGridFrameBuffer.bind();
             glClearColor(0, 0, 0, 0);
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
             GLERR;
 
-            quadTreeGridGlObj.set_quad_tree_nodes(quadTreeNodes);
-            GLERR;
+            if (quadTreeNodesChanged && !sharedQuadTreeNodes) {
+                quadTreeGridGlObj.set_quad_tree_nodes(quadTreeNodes->data);
+                GLERR;
+            }
             quadTreeGridGlObj.render();
             GLERR;
         }
@@ -177,8 +400,20 @@ bool SimulationWidget::on_render_handler(const Glib::RefPtr<Gdk::GLContext>& /*c
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
         GLERR;
 
-        // 4.2 Draw texture from frame buffer:
+        // 4.2 Draw the map tiles and the selected road on top of them:
+        mapTileObj.render();
+        mapObj.render();
+
+        // 4.3 Draw texture from frame buffer:
+        screenSquareObj.set_trail_visibility(blur);
         screenSquareObj.render();
+
+        cameraChanged = false;
+
+        // Keep drawing until all requested tiles arrived, even in case UI updates are disabled:
+        if (mapTileCache.has_pending()) {
+            glArea.queue_draw();
+        }
     } catch (const Gdk::GLError& gle) {
         SPDLOG_ERROR("An error occurred in the render callback of the GLArea: {} - {} - {}", gle.domain(), gle.code(), gle.what());
     }
@@ -194,7 +429,13 @@ bool SimulationWidget::on_render_handler(const Glib::RefPtr<Gdk::GLContext>& /*c
 bool SimulationWidget::on_tick(const Glib::RefPtr<Gdk::FrameClock>& /*frameClock*/) {
     assert(simulator);
 
+    // Only redraw in case something changed, so an idle UI does not cost any GPU time.
+    // Camera and setting changes queue a redraw by themselves:
+    bool redraw = simulator->get_map()->selectionGeneration != drawnSelectionGeneration;
     if (this->enableUiUpdates) {
+        redraw = redraw || simulator->has_new_entities() || (quadTreeGridVisible && simulator->has_new_quad_tree_nodes());
+    }
+    if (redraw) {
         glArea.queue_draw();
     }
     return true;
@@ -205,22 +446,52 @@ void SimulationWidget::on_realized() {
     try {
         glArea.throw_if_error();
 
-        mapFrameBuffer.init();
+        mapTileAtlasFrameBuffer.init();
         entitiesFrameBuffer.init();
         quadTreeGridFrameBuffer.init();
+        trailFrameBuffer.init();
+        trailScratchFrameBuffer.init();
+        heatmapFrameBuffer.init();
+
+        // The view matrix shared by all shaders drawing in map coordinates:
+        glGenBuffers(1, &cameraUbo);
+        glBindBuffer(GL_UNIFORM_BUFFER, cameraUbo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(float) * 16, nullptr, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, opengl::CAMERA_UNIFORM_BINDING, cameraUbo);
+        cameraChanged = true;
+        GLERR;
 
         // Get default frame buffer since in GTK it is not always 0:
         glGetIntegerv(GL_FRAMEBUFFER_BINDING, &defaultFb);
         glBindFramebuffer(GL_FRAMEBUFFER, defaultFb);
 
         mapObj.init();
-        blurObject.set_texture_size(entitiesFrameBuffer.get_texture_size_x(), entitiesFrameBuffer.get_texture_size_y());
+        mapTileObj.init();
+        mapTileObj.bind_texture(mapTileAtlasFrameBuffer.get_texture());
+        mapTileRasterObj.init();
+        mapTileCache.start(simulator->get_map());
         blurObject.init();
-        blurObject.bind_texture(entitiesFrameBuffer.get_texture());
+        blurObject.bind_entities_texture(entitiesFrameBuffer.get_texture());
+        heatmapObj.init();
+        heatmapObj.bind_texture(heatmapFrameBuffer.get_texture());
         entityObj.init();
+
+        // Prefer copying entities from the simulation buffer on the GPU and fall back to copying them via the host:
+        std::optional<sim::gl_interop::SharedBufferHandle> sharedEntitiesHandle = simulator->export_shared_entities();
+        if (sharedEntitiesHandle && entityObj.import_shared_entities(*sharedEntitiesHandle) && import_shared_buffer_sync()) {
+            sharedEntities = true;
+            simulator->enable_shared_entities();
+        } else {
+            SPDLOG_INFO("Copying entities from the simulation via the host.");
+        }
         quadTreeGridGlObj.init();
-        screenSquareObj.bind_texture(mapFrameBuffer.get_texture(), entitiesFrameBuffer.get_texture(), quadTreeGridFrameBuffer.get_texture());
+        if (sharedEntities) {
+            std::optional<sim::gl_interop::SharedBufferHandle> sharedQuadTreeNodesHandle = simulator->export_shared_quad_tree_nodes();
+            sharedQuadTreeNodes = sharedQuadTreeNodesHandle && quadTreeGridGlObj.import_shared_quad_tree_nodes(*sharedQuadTreeNodesHandle);
+        }
+        screenSquareObj.bind_texture(entitiesFrameBuffer.get_texture(), quadTreeGridFrameBuffer.get_texture(), trailFrameBuffer.get_texture());
         screenSquareObj.init();
+        screenSquareObj.set_quad_tree_grid_visibility(quadTreeGridVisible);
     } catch (const Gdk::GLError& gle) {
         SPDLOG_ERROR("An error occurred making the context current during realize: {} - {} - {}", gle.domain(), gle.code(), gle.what());
     }
@@ -231,15 +502,32 @@ void SimulationWidget::on_unrealized() {
     try {
         glArea.throw_if_error();
 
+        mapTileCache.stop();
+        if (sharedReadySemaphore) {
+            glDeleteSemaphoresEXT(1, &sharedReadySemaphore);
+            sharedReadySemaphore = 0;
+        }
+        if (sharedReleasedSemaphore) {
+            glDeleteSemaphoresEXT(1, &sharedReleasedSemaphore);
+            sharedReleasedSemaphore = 0;
+        }
         mapObj.cleanup();
+        mapTileObj.cleanup();
+        mapTileRasterObj.cleanup();
         blurObject.cleanup();
+        heatmapObj.cleanup();
         entityObj.cleanup();
         quadTreeGridGlObj.cleanup();
         screenSquareObj.cleanup();
 
+        heatmapFrameBuffer.cleanup();
+        trailScratchFrameBuffer.cleanup();
+        trailFrameBuffer.cleanup();
         quadTreeGridFrameBuffer.cleanup();
         entitiesFrameBuffer.cleanup();
-        mapFrameBuffer.cleanup();
+        mapTileAtlasFrameBuffer.cleanup();
+        glDeleteBuffers(1, &cameraUbo);
+        cameraUbo = 0;
     } catch (const Gdk::GLError& gle) {
         SPDLOG_ERROR("An error occurred deleting the context current during unrealize: {} - {} - {}", gle.domain(), gle.code(), gle.what());
     }
@@ -250,48 +538,51 @@ void SimulationWidget::on_glArea_clicked(int /*nPress*/, double x, double y) {
     const std::shared_ptr<sim::Map> map = simulator->get_map();
     assert(map);
 
-    // Invert since coordinates are inverted on the map:
-    // x = glArea.get_width() - x;
-    y = glArea.get_height() - y;
-
     // Scale up to map size:
-    x *= map->width / sim::MAX_RENDER_RESOLUTION_X;
-    y *= map->height / sim::MAX_RENDER_RESOLUTION_Y;
-    sim::Vec2 pos{static_cast<float>(x), static_cast<float>(y)};
+    sim::Vec2 pos = camera.screen_to_map({static_cast<float>(x), static_cast<float>(y)});
+    pos.x *= map->width;
+    pos.y *= map->height;
 
-    if (map->roads.empty()) {
+    std::optional<sim::RoadHit> hit = map->nearest_road(pos);
+    if (!hit) {
         return;
     }
-
-    // Get closest road:
-    size_t roadIndex = 0;
-    double shortestDist = std::numeric_limits<double>::max();
-    for (size_t i = 0; i < map->roads.size(); i++) {
-        // Start:
-        double newDist = map->roads[i].start.pos.dist(pos);
-        assert(newDist >= 0);
-        if (newDist < shortestDist) {
-            shortestDist = newDist;
-            roadIndex = i;
-        }
-
-        // End:
-        newDist = map->roads[i].end.pos.dist(pos);
-        assert(newDist >= 0);
-        if (newDist < shortestDist) {
-            shortestDist = newDist;
-            roadIndex = i;
-        }
-    }
+    const size_t roadIndex = hit->roadIndex;
 
     map->select_road(roadIndex);
-    // Ensure we rerender the map once the road selection changed:
-    mapRendered = false;
+    glArea.queue_draw();
 
     float x1 = map->roads[roadIndex].start.pos.x;
     float x2 = map->roads[roadIndex].end.pos.x;
     float y1 = map->roads[roadIndex].start.pos.y;
     float y2 = map->roads[roadIndex].end.pos.y;
-    SPDLOG_DEBUG("Road ({}) selected between position ({}|{}) and ({}|{}) with distance of {} meters.", roadIndex, x1, y1, x2, y2, shortestDist);
+    SPDLOG_DEBUG("Road ({}) selected between position ({}|{}) and ({}|{}) with distance of {} meters.", map->roadIds[roadIndex], x1, y1, x2, y2, hit->distance);
+}
+
+void SimulationWidget::on_drag_begin(double /*x*/, double /*y*/) {
+    if (dragGesture->get_current_button() == GDK_BUTTON_PRIMARY) {
+        dragGesture->set_state(Gtk::EventSequenceState::DENIED);
+        return;
+    }
+    lastDragOffset = {};
+}
+
+void SimulationWidget::on_drag_update(double offsetX, double offsetY) {
+    const sim::Vec2 offset{static_cast<float>(offsetX), static_cast<float>(offsetY)};
+    camera.pan({offset.x - lastDragOffset.x, offset.y - lastDragOffset.y});
+    lastDragOffset = offset;
+    cameraChanged = true;
+    queue_view_update();
+}
+
+bool SimulationWidget::on_scroll(double /*dx*/, double dy) {
+    camera.zoom_at(camera.get_zoom_factor() * std::pow(1.25F, static_cast<float>(-dy)), pointerPos);
+    cameraChanged = true;
+    queue_view_update();
+    return true;
+}
+
+void SimulationWidget::on_pointer_motion(double x, double y) {
+    pointerPos = {static_cast<float>(x), static_cast<float>(y)};
 }
 }  // namespace ui::widgets
@@ -1,31 +1,43 @@
 #pragma once
 
 #include "opengl/BlurGlObject.hpp"
+#include "opengl/Camera.hpp"
 #include "opengl/EntityGlObject.hpp"
+#include "opengl/HeatmapGlObject.hpp"
 #include "opengl/MapGlObject.hpp"
+#include "opengl/MapTileCache.hpp"
+#include "opengl/MapTileGlObject.hpp"
+#include "opengl/MapTileRasterGlObject.hpp"
 #include "opengl/QuadTreeGridGlObject.hpp"
 #include "opengl/ScreenSquareGlObject.hpp"
 #include "opengl/fb/EntitiesFrameBuffer.hpp"
-#include "opengl/fb/MapFrameBuffer.hpp"
+#include "opengl/fb/HeatmapFrameBuffer.hpp"
+#include "opengl/fb/MapTileAtlasFrameBuffer.hpp"
 #include "opengl/fb/QuadTreeGridFrameBuffer.hpp"
+#include "opengl/fb/TrailFrameBuffer.hpp"
 #include "sim/Entity.hpp"
 #include "sim/GpuQuadTree.hpp"
 #include "sim/Simulator.hpp"
 #include "ui/widgets/opengl/QuadTreeGridGlObject.hpp"
 #include "utils/TickDurationHistory.hpp"
 #include "utils/TickRate.hpp"
+#include "utils/TripleBuffer.hpp"
 #include <memory>
 #include <epoxy/gl.h>
 #include <gtkmm.h>
 #include <gtkmm/glarea.h>
-#include <gtkmm/scrolledwindow.h>
+#include <gtkmm/box.h>
+#include <gtkmm/gesturedrag.h>
 
 namespace ui::widgets {
-class SimulationWidget : public Gtk::ScrolledWindow {
+class SimulationWidget : public Gtk::Box {
  private:
     std::shared_ptr<sim::Simulator> simulator{nullptr};
-    std::shared_ptr<std::vector<sim::Entity>> entities{nullptr};
-    std::shared_ptr<std::vector<sim::gpu_quad_tree::Node>> quadTreeNodes{nullptr};
+    /**
+     * The latest snapshots acquired from the simulation. Valid until the next snapshot gets acquired.
+     **/
+    const utils::Snapshot<std::vector<sim::RenderEntity>>* entities{nullptr};
+    const utils::Snapshot<std::vector<sim::gpu_quad_tree::Node>>* quadTreeNodes{nullptr};
 
     utils::TickDurationHistory fpsHistory{};
     utils::TickRate fps{};
@@ -35,19 +47,66 @@ class SimulationWidget : public Gtk::ScrolledWindow {
 
     opengl::EntityGlObject entityObj{};
     opengl::MapGlObject mapObj{};
+    opengl::MapTileGlObject mapTileObj{};
+    opengl::MapTileRasterGlObject mapTileRasterObj{};
     opengl::ScreenSquareGlObject screenSquareObj{};
     opengl::BlurGlObject blurObject{};
+    opengl::HeatmapGlObject heatmapObj{};
     opengl::QuadTreeGridGlObject quadTreeGridGlObj{};
 
-    opengl::fb::MapFrameBuffer mapFrameBuffer;
+    opengl::fb::MapTileAtlasFrameBuffer mapTileAtlasFrameBuffer;
     opengl::fb::EntitiesFrameBuffer entitiesFrameBuffer;
     opengl::fb::QuadTreeGridFrameBuffer quadTreeGridFrameBuffer;
-    bool mapRendered{false};
+    /**
+     * Holds the downsampled entity trails.
+     * trailScratchFrameBuffer receives the result of the horizontal blur pass, so no pass reads from the frame buffer it writes to.
+     **/
+    opengl::fb::TrailFrameBuffer trailFrameBuffer;
+    opengl::fb::TrailFrameBuffer trailScratchFrameBuffer;
+    opengl::fb::HeatmapFrameBuffer heatmapFrameBuffer;
+    opengl::tiles::MapTileCache mapTileCache{};
+    opengl::Camera camera{};
+    GLuint cameraUbo{0};
+    /**
+     * True in case the camera moved since the last frame.
+     * Entities and the quad tree grid get drawn in screen space, so they have to be redrawn in this case.
+     **/
+    bool cameraChanged{true};
+    /**
+     * Incremented every time the camera or a render setting changes.
+     **/
+    uint64_t viewGeneration{0};
+    /**
+     * The map selection generation of the last frame. Allows redrawing in case the selection changed outside of this widget.
+     **/
+    uint64_t drawnSelectionGeneration{0};
+    sim::Vec2 lastDragOffset{};
+    sim::Vec2 pointerPos{};
     bool blur{false};
+    /**
+     * True in case the trails have to be cleared before the next update, since they are outdated.
+     **/
+    bool trailsOutdated{true};
     bool quadTreeGridVisible{false};
+    float heatmapZoomThreshold{opengl::DEFAULT_HEATMAP_ZOOM_THRESHOLD};
+
+    /**
+     * True in case entities get copied on the GPU from the buffer shared with the simulation.
+     **/
+    bool sharedEntities{false};
+    /**
+     * True in case the quad tree nodes get copied on the GPU from the node buffer shared with the simulation.
+     * Only possible in case sharedEntities is true as well, since both get handed over together.
+     **/
+    bool sharedQuadTreeNodes{false};
+    /**
+     * Imported from the simulation. Signaled by Vulkan once the shared buffers got written and by OpenGL once it is done reading them.
+     **/
+    GLuint sharedReadySemaphore{0};
+    GLuint sharedReleasedSemaphore{0};
 
     Gtk::GLArea glArea;
-    float zoomFactor{1};
+    Glib::RefPtr<Gtk::GestureDrag> dragGesture;
 
  public:
     bool enableUiUpdates{true};
@@ -59,12 +118,62 @@ class SimulationWidget : public Gtk::ScrolledWindow {
 
     void set_zoom_factor(float zoomFactor);
     [[nodiscard]] float get_zoom_factor() const;
+    /**
+     * Centers the map and zooms so it fits into the widget.
+     **/
+    void zoom_fit();
+
+    /**
+     * Size of the offscreen frame buffers in pixels. Follows the size of the widget.
+     **/
+    [[nodiscard]] GLsizei get_render_width() const;
+    [[nodiscard]] GLsizei get_render_height() const;
 
     void set_blur(bool blur);
+    /**
+     * Number of screen pixels along each axis a trail pixel covers.
+     * Larger values reduce the fill cost of the trails.
+     **/
+    void set_trail_downsampling(GLsizei downsampling);
+    [[nodiscard]] GLsizei get_trail_downsampling() const;
+    /**
+     * Below this zoom factor entities get drawn as density heatmap instead of one rect each.
+     * 0 disables the heatmap.
+     **/
+    void set_heatmap_zoom_threshold(float heatmapZoomThreshold);
+    [[nodiscard]] float get_heatmap_zoom_threshold() const;
+    [[nodiscard]] bool is_heatmap_active() const;
+    void set_entity_render_mode(opengl::EntityRenderMode entityRenderMode);
+    [[nodiscard]] opengl::EntityRenderMode get_entity_render_mode() const;
     void set_quad_tree_grid_visibility(bool quadTreeGridVisible);
+    /**
+     * Changes every time the view changes, e.g. while zooming or resizing.
+     * Allows overlays to only redraw in case the values they show changed.
+     **/
+    [[nodiscard]] uint64_t get_view_generation() const;
 
  private:
     void prep_widget();
+    /**
+     * Increments the view generation and schedules a redraw.
+     **/
+    void queue_view_update();
+    /**
+     * Reallocates the offscreen frame buffers in case the size of the GL area changed.
+     * Returns true in case they got reallocated.
+     **/
+    bool resize_frame_buffers(GLsizei width, GLsizei height);
+    void update_camera_uniform() const;
+    /**
+     * Imports the semaphores for handing over the shared buffers. Returns false in case importing failed.
+     **/
+    bool import_shared_buffer_sync();
+    /**
+     * Copies the shared entities and quad tree nodes acquired from the simulation and hands them back right away.
+     * All drawing happens from the copies, so OpenGL never reads the shared buffers without holding them.
+     **/
+    void copy_shared_entities();
+    [[nodiscard]] float calc_heatmap_saturation_count() const;
 
     //-----------------------------Events:-----------------------------
     bool on_render_handler(const Glib::RefPtr<Gdk::GLContext>& ctx);
@@ -72,5 +181,9 @@ class SimulationWidget : public Gtk::ScrolledWindow {
     void on_realized();
     void on_unrealized();
     void on_glArea_clicked(int nPress, double x, double y);
+    void on_drag_begin(double x, double y);
+    void on_drag_update(double offsetX, double offsetY);
+    bool on_scroll(double dx, double dy);
+    void on_pointer_motion(double x, double y);
 };
 }  // namespace ui::widgets
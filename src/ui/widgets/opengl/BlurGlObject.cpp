@@ -1,18 +1,24 @@
-
 #include "BlurGlObject.hpp"
-#include "sim/Entity.hpp"
-#include <array>
 #include <cassert>
 #include <epoxy/gl_generated.h>
 
 namespace ui::widgets::opengl {
-void BlurGlObject::bind_texture(GLuint inputTexture) {
-    this->inputTexture = inputTexture;
+void BlurGlObject::set_pass(BlurPass pass, GLuint inputTexture) {
+    this->pass = pass;
+    textures[0] = inputTexture;
+}
+
+void BlurGlObject::bind_entities_texture(GLuint entitiesTexture) {
+    textures[1] = entitiesTexture;
 }
 
-void BlurGlObject::set_texture_size(GLsizei sizeX, GLsizei sizeY) {
-    inputTextureSizeX = sizeX;
-    inputTextureSizeY = sizeY;
+void BlurGlObject::set_downsampling(GLsizei downsampling) {
+    assert(downsampling > 0);
+    this->downsampling = downsampling;
+}
+
+GLsizei BlurGlObject::get_downsampling() const {
+    return downsampling;
 }
 
 void BlurGlObject::init_internal() {
@@ -55,28 +61,23 @@ void BlurGlObject::init_internal() {
     // Bind attributes:
     glUseProgram(shaderProg);
     glUniform1i(glGetUniformLocation(shaderProg, "inputTexture"), 0);
+    glUniform1i(glGetUniformLocation(shaderProg, "entitiesTexture"), 1);
 
-    // Bind uniform offsets buffer:
-    glGenBuffers(1, &offsetsUBO);
-    glBindBuffer(GL_UNIFORM_BUFFER, offsetsUBO);
-    GLERR;
-    assert(inputTextureSizeX > 0);
-    assert(inputTextureSizeY > 0);
-    float stepX = 1 / static_cast<float>(inputTextureSizeX);
-    float stepY = 1 / static_cast<float>(inputTextureSizeY);
-    std::array<sim::Vec2, 9> data{{{-stepX, -stepY}, {0, -stepY}, {stepX, -stepY}, {-stepX, 0}, {0, 0}, {stepX, 0}, {-stepX, stepY}, {0, stepY}, {stepX, stepY}}};
-    glBufferData(GL_UNIFORM_BUFFER, sizeof(sim::Vec2) * data.size(), data.data(), GL_STATIC_DRAW);
-    GLERR;
-    GLuint offsetsIndex = glGetUniformBlockIndex(shaderProg, "blurArrayBlock");
-    GLERR;
-    glUniformBlockBinding(shaderProg, offsetsIndex, 0);
-    GLERR;
-    glBindBufferBase(GL_UNIFORM_BUFFER, 0, offsetsUBO);
+    passConst = glGetUniformLocation(shaderProg, "pass");
+    downsamplingConst = glGetUniformLocation(shaderProg, "downsampling");
+    sideWeightConst = glGetUniformLocation(shaderProg, "sideWeight");
     GLERR;
 }
 
 void BlurGlObject::render_internal() {
-    glBindTexture(GL_TEXTURE_2D, inputTexture);
+    // A full resolution 3x3 box blur spreads each pixel with a variance of 2/3 pixels² per axis and update.
+    // The variance of the [w, 1 - 2w, w] kernel is 2w trail pixels², each of them downsampling² screen pixels²:
+    const float sideWeight = 1.0F / (3.0F * static_cast<float>(downsampling * downsampling));
+    glUniform1ui(passConst, static_cast<GLuint>(pass));
+    glUniform1i(downsamplingConst, downsampling);
+    glUniform1f(sideWeightConst, sideWeight);
+
+    glBindTextures(0, static_cast<GLsizei>(textures.size()), textures.data());
     glDrawArrays(GL_POINTS, 0, 1);
     GLERR;
 }
@@ -84,6 +85,6 @@ void BlurGlObject::render_internal() {
 void BlurGlObject::cleanup_internal() {
     glDeleteShader(fragShader);
     glDeleteShader(geomShader);
-    glDeleteShader(fragShader);
+    glDeleteShader(vertShader);
 }
-}  // namespace ui::widgets::opengl
\ No newline at end of file
+}  // namespace ui::widgets::opengl
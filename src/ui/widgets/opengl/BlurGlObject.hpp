@@ -8,16 +8,48 @@
 #include <gtkmm/glarea.h>
 
 namespace ui::widgets::opengl {
+/**
+ * Each trail pixel covers DEFAULT_TRAIL_DOWNSAMPLING x DEFAULT_TRAIL_DOWNSAMPLING screen pixels by default.
+ **/
+constexpr GLsizei DEFAULT_TRAIL_DOWNSAMPLING = 4;
+
+/**
+ * Has to match the pass constants inside blur.frag.
+ **/
+enum class BlurPass : GLuint {
+    /**
+     * Blurs the trail along the x axis.
+     **/
+    HORIZONTAL = 0,
+    /**
+     * Blurs the trail along the y axis, lets it fade and adds the current entities on top.
+     **/
+    VERTICAL = 1,
+};
+
+/**
+ * Separable blur producing the entity trails.
+ * A trail update consists of a HORIZONTAL and a VERTICAL pass, each reading from the frame buffer the previous one wrote to.
+ * Runs at a lower resolution than the screen, where the blur weights get scaled so trails spread as fast as with a full resolution 3x3 box blur.
+ **/
 class BlurGlObject : public AbstractGlObject {
  private:
     GLuint vertShader{0};
     GLuint geomShader{0};
     GLuint fragShader{0};
 
-    GLuint inputTexture{0};
-    GLsizei inputTextureSizeX{0};
-    GLsizei inputTextureSizeY{0};
-    GLuint offsetsUBO{0};
+    GLint passConst{0};
+    GLint downsamplingConst{0};
+    GLint sideWeightConst{0};
+
+    BlurPass pass{BlurPass::HORIZONTAL};
+    GLsizei downsampling{DEFAULT_TRAIL_DOWNSAMPLING};
+
+    /**
+     * textures[0] is the trail texture of the previous pass.
+     * textures[1] is the entities texture.
+     **/
+    std::array<GLuint, 2> textures{};
 
  public:
     BlurGlObject() = default;
@@ -29,8 +61,20 @@ class BlurGlObject : public AbstractGlObject {
     BlurGlObject& operator=(BlurGlObject& other) = delete;
     BlurGlObject& operator=(BlurGlObject&& old) = delete;
 
-    void bind_texture(GLuint inputTexture);
-    void set_texture_size(GLsizei sizeX, GLsizei sizeY);
+    /**
+     * Selects the pass the next render() call executes and the trail texture it reads from.
+     * The input texture must not be attached to the currently bound frame buffer.
+     **/
+    void set_pass(BlurPass pass, GLuint inputTexture);
+    /**
+     * The full resolution entities texture that gets added to the trail during the VERTICAL pass.
+     **/
+    void bind_entities_texture(GLuint entitiesTexture);
+    /**
+     * Number of screen pixels along each axis a trail pixel covers.
+     **/
+    void set_downsampling(GLsizei downsampling);
+    [[nodiscard]] GLsizei get_downsampling() const;
 
  protected:
     void init_internal() override;
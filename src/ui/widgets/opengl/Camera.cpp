@@ -0,0 +1,80 @@
+#include "Camera.hpp"
+#include <algorithm>
+#include <cassert>
+
+namespace ui::widgets::opengl {
+bool Camera::set_viewport_size(const sim::Vec2& viewportSize) {
+    // Prevent divisions by zero for not yet allocated widgets:
+    const sim::Vec2 size{std::max(viewportSize.x, 1.0F), std::max(viewportSize.y, 1.0F)};
+    if (size.x == this->viewportSize.x && size.y == this->viewportSize.y) {
+        return false;
+    }
+    this->viewportSize = size;
+    return true;
+}
+
+const sim::Vec2& Camera::get_viewport_size() const {
+    return viewportSize;
+}
+
+void Camera::set_zoom_factor(float zoomFactor) {
+    assert(zoomFactor > 0);
+    this->zoomFactor = std::clamp(zoomFactor, CAMERA_MIN_ZOOM_FACTOR, CAMERA_MAX_ZOOM_FACTOR);
+}
+
+float Camera::get_zoom_factor() const {
+    return zoomFactor;
+}
+
+void Camera::zoom_at(float zoomFactor, const sim::Vec2& screenPos) {
+    const sim::Vec2 before = screen_to_map(screenPos);
+    set_zoom_factor(zoomFactor);
+    const sim::Vec2 after = screen_to_map(screenPos);
+    set_center({center.x + before.x - after.x, center.y + before.y - after.y});
+}
+
+void Camera::set_center(const sim::Vec2& center) {
+    // Keep at least the map center reachable:
+    this->center = {std::clamp(center.x, 0.0F, 1.0F), std::clamp(center.y, 0.0F, 1.0F)};
+}
+
+const sim::Vec2& Camera::get_center() const {
+    return center;
+}
+
+void Camera::pan(const sim::Vec2& screenDelta) {
+    // The y axis of the map points upwards:
+    const float mapPixels = get_map_pixels();
+    set_center({center.x - (screenDelta.x / mapPixels), center.y + (screenDelta.y / mapPixels)});
+}
+
+float Camera::get_map_pixels() const {
+    return CAMERA_MAP_PIXELS * zoomFactor;
+}
+
+sim::Vec2 Camera::screen_to_map(const sim::Vec2& screenPos) const {
+    const float mapPixels = get_map_pixels();
+    return {center.x + ((screenPos.x - (viewportSize.x / 2)) / mapPixels),
+            center.y - ((screenPos.y - (viewportSize.y / 2)) / mapPixels)};
+}
+
+sim::Vec2 Camera::get_visible_min() const {
+    const float mapPixels = get_map_pixels();
+    return {center.x - (viewportSize.x / 2 / mapPixels), center.y - (viewportSize.y / 2 / mapPixels)};
+}
+
+sim::Vec2 Camera::get_visible_max() const {
+    const float mapPixels = get_map_pixels();
+    return {center.x + (viewportSize.x / 2 / mapPixels), center.y + (viewportSize.y / 2 / mapPixels)};
+}
+
+std::array<float, 16> Camera::calc_view_matrix() const {
+    // One normalized map unit spans mapPixels screen pixels, while the screen spans 2 in normalized device coordinates:
+    const float scaleX = 2 * get_map_pixels() / viewportSize.x;
+    const float scaleY = 2 * get_map_pixels() / viewportSize.y;
+    return {scaleX, 0, 0, 0,
+            0, scaleY, 0, 0,
+            0, 0, 1, 0,
+            -center.x * scaleX, -center.y * scaleY, 0, 1};
+}
+}  // namespace ui::widgets::opengl
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "sim/Entity.hpp"
+#include <array>
+#include <cstdint>
+
+namespace ui::widgets::opengl {
+/**
+ * Number of screen pixels the whole map spans at a zoom factor of 1.
+ **/
+constexpr float CAMERA_MAP_PIXELS = 8192;
+constexpr float CAMERA_MIN_ZOOM_FACTOR = 1.0F / 64;
+/**
+ * Beyond this the map tiles of the highest level would get magnified.
+ **/
+constexpr float CAMERA_MAX_ZOOM_FACTOR = 8;
+
+/**
+ * The uniform buffer binding the view matrix is bound to.
+ * Has to match the binding of the cameraBlock inside the shaders.
+ **/
+constexpr uint32_t CAMERA_UNIFORM_BINDING = 1;
+
+/**
+ * Pan and zoom of the map on screen.
+ * Positions on the map are normalized to [0, 1] with the y axis pointing upwards.
+ * Positions on screen are in pixels with the origin at the top left.
+ * Does not issue any OpenGL calls by itself.
+ **/
+class Camera {
+ private:
+    /**
+     * Normalized map position in the center of the screen.
+     **/
+    sim::Vec2 center{0.5F, 0.5F};
+    float zoomFactor{1};
+    sim::Vec2 viewportSize{1, 1};
+
+ public:
+    /**
+     * Returns true in case the size changed.
+     **/
+    bool set_viewport_size(const sim::Vec2& viewportSize);
+    [[nodiscard]] const sim::Vec2& get_viewport_size() const;
+
+    void set_zoom_factor(float zoomFactor);
+    [[nodiscard]] float get_zoom_factor() const;
+    /**
+     * Zooms while keeping the map position below the given screen position in place.
+     **/
+    void zoom_at(float zoomFactor, const sim::Vec2& screenPos);
+
+    void set_center(const sim::Vec2& center);
+    [[nodiscard]] const sim::Vec2& get_center() const;
+    /**
+     * Moves the map by the given number of screen pixels.
+     **/
+    void pan(const sim::Vec2& screenDelta);
+
+    /**
+     * Number of screen pixels the whole map spans.
+     **/
+    [[nodiscard]] float get_map_pixels() const;
+
+    [[nodiscard]] sim::Vec2 screen_to_map(const sim::Vec2& screenPos) const;
+    /**
+     * The part of the map visible on screen, not clamped to the map bounds.
+     **/
+    [[nodiscard]] sim::Vec2 get_visible_min() const;
+    [[nodiscard]] sim::Vec2 get_visible_max() const;
+
+    /**
+     * Column major 4x4 matrix transforming normalized map positions to normalized device coordinates.
+     **/
+    [[nodiscard]] std::array<float, 16> calc_view_matrix() const;
+};
+}  // namespace ui::widgets::opengl
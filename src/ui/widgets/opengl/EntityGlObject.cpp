@@ -2,14 +2,86 @@
 #include "EntityGlObject.hpp"
 #include "sim/Entity.hpp"
 #include "sim/Simulator.hpp"
+#include <array>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string>
 #include <epoxy/gl_generated.h>
 
 namespace ui::widgets::opengl {
-void EntityGlObject::set_entities(const std::shared_ptr<std::vector<sim::Entity>>& entities) {
+namespace {
+/**
+ * RGBA color for each sim::EntityPaletteIndex.
+ **/
+constexpr std::array<std::array<float, 4>, static_cast<size_t>(sim::EntityPaletteIndex::COUNT)> PALETTE{{
+    {1.0F, 0.0F, 0.0F, 1.0F},  // UNINITIALIZED
+    {0.0F, 1.0F, 0.0F, 1.0F},  // NO_COLLISION
+    {0.0F, 0.0F, 1.0F, 1.0F},  // COLLISION
+}};
+
+/**
+ * Layout defined by OpenGL for glDrawArraysIndirect().
+ **/
+struct DrawArraysIndirectCommand {
+    GLuint count{0};
+    GLuint instanceCount{0};
+    GLuint first{0};
+    GLuint baseInstance{0};
+};
+
+/**
+ * The culling pass adds the visible entities to the point count of the first and the instance count of the second command.
+ **/
+constexpr std::array<DrawArraysIndirectCommand, 2> INITIAL_DRAW_COMMANDS{{
+    {0, 1, 0, 0},  // One point per entity
+    {4, 0, 0, 0},  // One rect instance per entity
+}};
+constexpr size_t POINTS_DRAW_COMMAND_OFFSET = 0;
+constexpr size_t INSTANCED_DRAW_COMMAND_OFFSET = sizeof(DrawArraysIndirectCommand);
+}  // namespace
+
+void EntityGlObject::set_entities(const std::vector<sim::RenderEntity>& entities) {
+    assert(entities.size() <= sim::MAX_ENTITIES);
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    entityCount = entities ? static_cast<GLsizei>(entities->size()) : 0;
-    glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(sizeof(sim::Entity)) * entityCount, static_cast<void*>(entities->data()));
+    entityCount = static_cast<GLsizei>(entities.size());
+    glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(sizeof(sim::RenderEntity)) * entityCount, entities.data());
+}
+
+bool EntityGlObject::import_shared_entities(const sim::gl_interop::SharedBufferHandle& handle) {
+    if (!utils::import_shared_buffer(handle, sharedMemory, sharedVbo)) {
+        return false;
+    }
+
+    entityCount = static_cast<GLsizei>(handle.size / sizeof(sim::RenderEntity));
+    assert(entityCount <= static_cast<GLsizei>(sim::MAX_ENTITIES));
+    GLERR;
+
+    SPDLOG_INFO("Copying entities on the GPU from the shared Vulkan buffer.");
+    return true;
+}
+
+void EntityGlObject::copy_shared_entities() const {
+    assert(sharedVbo);
+    glCopyNamedBufferSubData(sharedVbo, vbo, 0, 0, static_cast<GLsizeiptr>(sizeof(sim::RenderEntity)) * entityCount);
+    GLERR;
+}
+
+GLuint EntityGlObject::get_shared_vbo() const {
+    return sharedVbo;
+}
+
+void EntityGlObject::bind_attributes() const {
+    // Integer attribute, resolved to a color through the palette inside the vertex shader:
+    GLint paletteIndexAttrib = glGetAttribLocation(shaderProg, "paletteIndex");
+    glEnableVertexAttribArray(paletteIndexAttrib);
+    // NOLINTNEXTLINE (cppcoreguidelines-pro-type-reinterpret-cast)
+    glVertexAttribIPointer(paletteIndexAttrib, 1, GL_UNSIGNED_INT, sizeof(sim::RenderEntity), reinterpret_cast<void*>(sizeof(uint16_t) * 2));
+
+    // Quantized relative to the world size. Gets scaled back inside the vertex shader:
+    GLint posAttrib = glGetAttribLocation(shaderProg, "position");
+    glEnableVertexAttribArray(posAttrib);
+    glVertexAttribPointer(posAttrib, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(sim::RenderEntity), nullptr);
 }
 
 void EntityGlObject::init_internal() {
@@ -17,12 +89,18 @@ void EntityGlObject::init_internal() {
     const std::shared_ptr<sim::Map> map = simulator->get_map();
     assert(map);
 
-    // Vertex data:
-    assert(simulator);
-    std::shared_ptr<std::vector<sim::Entity>> entities = simulator->get_entities();
-    entityCount = entities ? static_cast<GLsizei>(entities->size()) : 0;
-    assert(entities);
-    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(sim::Entity) * entities->size()), static_cast<void*>(entities->data()), GL_DYNAMIC_DRAW);
+    // Vertex data. Nothing gets drawn until the first entities arrive via set_entities():
+    entityCount = 0;
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(sim::RenderEntity) * sim::MAX_ENTITIES), nullptr, GL_DYNAMIC_DRAW);
+
+    // Only ever written by the culling pass:
+    glGenBuffers(1, &visibleVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, visibleVbo);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(sim::RenderEntity) * sim::MAX_ENTITIES), nullptr, GL_DYNAMIC_COPY);
+    glGenBuffers(1, &drawCommandBuffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, drawCommandBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(INITIAL_DRAW_COMMANDS), INITIAL_DRAW_COMMANDS.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
 
     // Compile shader:
     vertShader = compile_shader("/ui/shader/entity/entity.vert", GL_VERTEX_SHADER);
@@ -31,61 +109,176 @@ void EntityGlObject::init_internal() {
     assert(geomShader > 0);
     fragShader = compile_shader("/ui/shader/entity/entity.frag", GL_FRAGMENT_SHADER);
     assert(fragShader > 0);
+    instancedVertShader = compile_shader("/ui/shader/entity/entity_instanced.vert", GL_VERTEX_SHADER);
+    assert(instancedVertShader > 0);
+    pointVertShader = compile_shader("/ui/shader/entity/entity_point.vert", GL_VERTEX_SHADER);
+    assert(pointVertShader > 0);
+    densityVertShader = compile_shader("/ui/shader/entity/entity_density.vert", GL_VERTEX_SHADER);
+    assert(densityVertShader > 0);
+    densityFragShader = compile_shader("/ui/shader/entity/entity_density.frag", GL_FRAGMENT_SHADER);
+    assert(densityFragShader > 0);
+    cullShader = compile_shader("/ui/shader/entity/entity_cull.comp", GL_COMPUTE_SHADER);
+    assert(cullShader > 0);
+
+    // Prepare programs:
+    shaderProg = link_program(shaderProg, {vertShader, geomShader, fragShader}, *map);
+    instancedShaderProg = link_program(glCreateProgram(), {instancedVertShader, fragShader}, *map);
+    pointShaderProg = link_program(glCreateProgram(), {pointVertShader, fragShader}, *map);
+    pointViewportSizeConst = glGetUniformLocation(pointShaderProg, "viewportSize");
+    densityShaderProg = link_program(glCreateProgram(), {densityVertShader, densityFragShader}, *map);
+    cullShaderProg = link_program(glCreateProgram(), {cullShader}, *map);
+    cullViewportSizeConst = glGetUniformLocation(cullShaderProg, "viewportSize");
+    cullEntityCountConst = glGetUniformLocation(cullShaderProg, "entityCount");
+    GLERR;
+
+    // Bind attributes. All programs share the same attribute locations and only draw the visible entities:
+    glUseProgram(shaderProg);
+    glBindBuffer(GL_ARRAY_BUFFER, visibleVbo);
+    bind_attributes();
+    GLERR;
+}
 
-    // Prepare program:
-    glAttachShader(shaderProg, vertShader);
-    glAttachShader(shaderProg, geomShader);
-    glAttachShader(shaderProg, fragShader);
-    glBindFragDataLocation(shaderProg, 0, "outColor");
-    glLinkProgram(shaderProg);
+GLuint EntityGlObject::link_program(GLuint prog, const std::vector<GLuint>& shaders, const sim::Map& map) {
+    for (GLuint shader : shaders) {
+        glAttachShader(prog, shader);
+    }
+    glBindFragDataLocation(prog, 0, "outColor");
+    glLinkProgram(prog);
     GLERR;
 
     // Check for errors during linking:
     GLint status = GL_FALSE;
-    glGetProgramiv(shaderProg, GL_LINK_STATUS, &status);
+    glGetProgramiv(prog, GL_LINK_STATUS, &status);
     if (status == GL_FALSE) {
         int log_len = 0;
-        glGetProgramiv(shaderProg, GL_INFO_LOG_LENGTH, &log_len);
+        glGetProgramiv(prog, GL_INFO_LOG_LENGTH, &log_len);
 
         std::string log_msg;
         log_msg.resize(log_len);
-        glGetProgramInfoLog(shaderProg, log_len, nullptr, static_cast<GLchar*>(log_msg.data()));
+        glGetProgramInfoLog(prog, log_len, nullptr, static_cast<GLchar*>(log_msg.data()));
         SPDLOG_ERROR("Linking entity shader program failed: {}", log_msg);
-        glDeleteProgram(shaderProg);
-        shaderProg = 0;
-    } else {
-        glDetachShader(shaderProg, fragShader);
-        glDetachShader(shaderProg, geomShader);
-        glDetachShader(shaderProg, vertShader);
+        glDeleteProgram(prog);
+        return 0;
+    }
+    for (GLuint shader : shaders) {
+        glDetachShader(prog, shader);
     }
     GLERR;
 
-    // Bind attributes:
-    glUseProgram(shaderProg);
-    GLint colAttrib = glGetAttribLocation(shaderProg, "color");
-    glEnableVertexAttribArray(colAttrib);
-    glVertexAttribPointer(colAttrib, 4, GL_FLOAT, GL_FALSE, sizeof(sim::Entity), nullptr);
+    glUseProgram(prog);
+    glUniform2f(glGetUniformLocation(prog, "worldSize"), map.width, map.height);
+    glUniform2f(glGetUniformLocation(prog, "rectSize"), 10, 10);
+    glUniform4fv(glGetUniformLocation(prog, "palette"), static_cast<GLsizei>(PALETTE.size()), PALETTE.front().data());
+    GLERR;
+    return prog;
+}
 
-    GLint posAttrib = glGetAttribLocation(shaderProg, "position");
-    glEnableVertexAttribArray(posAttrib);
-    // NOLINTNEXTLINE (cppcoreguidelines-pro-type-reinterpret-cast)
-    glVertexAttribPointer(posAttrib, 2, GL_FLOAT, GL_FALSE, sizeof(sim::Entity), reinterpret_cast<void*>(sizeof(sim::Rgba) + sizeof(sim::Vec4U)));
+void EntityGlObject::set_render_mode(EntityRenderMode renderMode) {
+    this->renderMode = renderMode;
+}
+
+EntityRenderMode EntityGlObject::get_render_mode() const {
+    return renderMode;
+}
+
+void EntityGlObject::cull_entities() const {
+    // Reset the visible entity counts:
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, drawCommandBuffer);
+    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(INITIAL_DRAW_COMMANDS), INITIAL_DRAW_COMMANDS.data());
+
+    // The margin depends on the size of the frame buffer we are drawing to:
+    std::array<GLint, 4> viewPort{};
+    glGetIntegerv(GL_VIEWPORT, viewPort.data());
+    glUseProgram(cullShaderProg);
+    glUniform2f(cullViewportSizeConst, static_cast<float>(viewPort[2]), static_cast<float>(viewPort[3]));
+    glUniform1ui(cullEntityCountConst, static_cast<GLuint>(entityCount));
 
-    worldSizeConst = glGetUniformLocation(shaderProg, "worldSize");
-    glUniform2f(worldSizeConst, map->width, map->height);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, vbo);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, visibleVbo);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, drawCommandBuffer);
+    glDispatchCompute((static_cast<GLuint>(entityCount) + ENTITY_CULL_WORK_GROUP_SIZE - 1) / ENTITY_CULL_WORK_GROUP_SIZE, 1, 1);
 
-    rectSizeConst = glGetUniformLocation(shaderProg, "rectSize");
-    glUniform2f(rectSizeConst, 10, 10);
+    // The draw commands and vertex attributes get sourced from the buffers written above.
+    // The next reset of the draw commands via glBufferSubData() must not race the atomic counter writes either:
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
     GLERR;
 }
 
 void EntityGlObject::render_internal() {
-    glDrawArrays(GL_POINTS, 0, entityCount);
+    cull_entities();
+
+    switch (renderMode) {
+        case EntityRenderMode::GEOMETRY_SHADER:
+            glUseProgram(shaderProg);
+            // NOLINTNEXTLINE (cppcoreguidelines-pro-type-reinterpret-cast, performance-no-int-to-ptr)
+            glDrawArraysIndirect(GL_POINTS, reinterpret_cast<const void*>(POINTS_DRAW_COMMAND_OFFSET));
+            break;
+
+        case EntityRenderMode::INSTANCED:
+            // Advance the entity attributes once per rect instead of once per vertex:
+            glUseProgram(instancedShaderProg);
+            glVertexAttribDivisor(0, 1);
+            glVertexAttribDivisor(1, 1);
+            // NOLINTNEXTLINE (cppcoreguidelines-pro-type-reinterpret-cast, performance-no-int-to-ptr)
+            glDrawArraysIndirect(GL_TRIANGLE_STRIP, reinterpret_cast<const void*>(INSTANCED_DRAW_COMMAND_OFFSET));
+            glVertexAttribDivisor(0, 0);
+            glVertexAttribDivisor(1, 0);
+            break;
+
+        case EntityRenderMode::POINT_SPRITE: {
+            // The point size depends on the size of the frame buffer we are drawing to:
+            std::array<GLint, 4> viewPort{};
+            glGetIntegerv(GL_VIEWPORT, viewPort.data());
+            glUseProgram(pointShaderProg);
+            glUniform2f(pointViewportSizeConst, static_cast<float>(viewPort[2]), static_cast<float>(viewPort[3]));
+            glEnable(GL_PROGRAM_POINT_SIZE);
+            // NOLINTNEXTLINE (cppcoreguidelines-pro-type-reinterpret-cast, performance-no-int-to-ptr)
+            glDrawArraysIndirect(GL_POINTS, reinterpret_cast<const void*>(POINTS_DRAW_COMMAND_OFFSET));
+            glDisable(GL_PROGRAM_POINT_SIZE);
+            break;
+        }
+    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void EntityGlObject::render_density() {
+    // Entities outside the viewport would end up in no heatmap cell anyway:
+    cull_entities();
+    glUseProgram(densityShaderProg);
+    glBindVertexArray(vao);
+
+    // Single pixel points summed up by additive blending:
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+    // NOLINTNEXTLINE (cppcoreguidelines-pro-type-reinterpret-cast, performance-no-int-to-ptr)
+    glDrawArraysIndirect(GL_POINTS, reinterpret_cast<const void*>(POINTS_DRAW_COMMAND_OFFSET));
+    glDisable(GL_BLEND);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    GLERR;
 }
 
 void EntityGlObject::cleanup_internal() {
+    if (sharedVbo) {
+        glDeleteBuffers(1, &sharedVbo);
+        glDeleteMemoryObjectsEXT(1, &sharedMemory);
+    }
+    glDeleteBuffers(1, &drawCommandBuffer);
+    glDeleteBuffers(1, &visibleVbo);
+
+    glDeleteProgram(cullShaderProg);
+    glDeleteProgram(densityShaderProg);
+    glDeleteProgram(pointShaderProg);
+    glDeleteProgram(instancedShaderProg);
+
+    glDeleteShader(cullShader);
+    glDeleteShader(densityFragShader);
+    glDeleteShader(densityVertShader);
+    glDeleteShader(pointVertShader);
+    glDeleteShader(instancedVertShader);
     glDeleteShader(fragShader);
     glDeleteShader(geomShader);
-    glDeleteShader(fragShader);
+    glDeleteShader(vertShader);
 }
 }  // namespace ui::widgets::opengl
\ No newline at end of file
@@ -2,21 +2,80 @@
 
 #include "AbstractGlObject.hpp"
 #include "sim/Entity.hpp"
+#include "sim/GlInterop.hpp"
+#include "sim/Map.hpp"
 #include <memory>
 #include <vector>
 #include <epoxy/gl.h>
 
 namespace ui::widgets::opengl {
+/**
+ * Has to match the local size of entity_cull.comp.
+ **/
+constexpr GLuint ENTITY_CULL_WORK_GROUP_SIZE = 256;
+
+enum class EntityRenderMode {
+    /**
+     * Expands every entity point into a rect inside a geometry shader.
+     **/
+    GEOMETRY_SHADER = 0,
+    /**
+     * Draws one instanced four vertex rect per entity.
+     **/
+    INSTANCED = 1,
+    /**
+     * Draws every entity as a single square point sprite.
+     **/
+    POINT_SPRITE = 2
+};
+
 class EntityGlObject : public AbstractGlObject {
  private:
     GLuint vertShader{0};
     GLuint geomShader{0};
     GLuint fragShader{0};
+    GLuint instancedVertShader{0};
+    GLuint pointVertShader{0};
+    GLuint densityVertShader{0};
+    GLuint densityFragShader{0};
+    GLuint cullShader{0};
+
+    // Programs for the non geometry shader render modes. shaderProg is used for EntityRenderMode::GEOMETRY_SHADER:
+    GLuint instancedShaderProg{0};
+    GLuint pointShaderProg{0};
+    GLint pointViewportSizeConst{0};
+    GLuint densityShaderProg{0};
+    GLuint cullShaderProg{0};
+    GLint cullViewportSizeConst{0};
+    GLint cullEntityCountConst{0};
 
-    GLint worldSizeConst{0};
-    GLint rectSizeConst{0};
+    /**
+     * The entities inside the viewport, compacted by the culling pass. All render modes draw from this buffer.
+     **/
+    GLuint visibleVbo{0};
+    /**
+     * Indirect draw commands holding the number of visible entities, filled by the culling pass.
+     **/
+    GLuint drawCommandBuffer{0};
 
     GLsizei entityCount{0};
+    EntityRenderMode renderMode{EntityRenderMode::INSTANCED};
+
+    // Render entities imported from Vulkan. Only copied into vbo:
+    GLuint sharedMemory{0};
+    GLuint sharedVbo{0};
+
+    void bind_attributes() const;
+    /**
+     * Links the given shaders into the given program and sets the uniforms shared by all render modes.
+     * Returns 0 in case linking failed.
+     **/
+    [[nodiscard]] static GLuint link_program(GLuint prog, const std::vector<GLuint>& shaders, const sim::Map& map);
+    /**
+     * Copies all entities inside the current viewport into visibleVbo and updates the draw commands accordingly.
+     * Runs entirely on the GPU, so drawing afterwards only costs as much as there are visible entities.
+     **/
+    void cull_entities() const;
 
  public:
     EntityGlObject() = default;
@@ -28,7 +87,27 @@ class EntityGlObject : public AbstractGlObject {
     EntityGlObject& operator=(EntityGlObject& other) = delete;
     EntityGlObject& operator=(EntityGlObject&& old) = delete;
 
-    void set_entities(const std::shared_ptr<std::vector<sim::Entity>>& entities);
+    void set_entities(const std::vector<sim::RenderEntity>& entities);
+    /**
+     * Imports the given Vulkan buffer, so copy_shared_entities() can be used instead of set_entities().
+     * Returns false in case the OpenGL implementation does not support importing it. In this case set_entities() has to be used.
+     * Takes ownership of the file descriptor in either case.
+     **/
+    bool import_shared_entities(const sim::gl_interop::SharedBufferHandle& handle);
+    /**
+     * Copies the entities from the shared buffer on the GPU. Everything gets drawn from the copy, so the shared buffer can be handed back right away.
+     * Must only be called while holding the shared buffer, after waiting for its ready semaphore.
+     **/
+    void copy_shared_entities() const;
+    [[nodiscard]] GLuint get_shared_vbo() const;
+    /**
+     * Instead of the entities, adds 1 to the red channel of the pixel each entity is located in.
+     * Used for accumulating the number of entities per cell into a float frame buffer for the heatmap.
+     **/
+    void render_density();
+
+    void set_render_mode(EntityRenderMode renderMode);
+    [[nodiscard]] EntityRenderMode get_render_mode() const;
 
  protected:
     void init_internal() override;
@@ -0,0 +1,72 @@
+#include "HeatmapGlObject.hpp"
+#include <cassert>
+#include <epoxy/gl_generated.h>
+
+namespace ui::widgets::opengl {
+void HeatmapGlObject::bind_texture(GLuint densityTexture) {
+    this->densityTexture = densityTexture;
+}
+
+void HeatmapGlObject::set_saturation_count(float saturationCount) {
+    assert(saturationCount > 0);
+    this->saturationCount = saturationCount;
+}
+
+void HeatmapGlObject::init_internal() {
+    // Compile shader:
+    vertShader = compile_shader("/ui/shader/heatmap/heatmap.vert", GL_VERTEX_SHADER);
+    assert(vertShader > 0);
+    geomShader = compile_shader("/ui/shader/heatmap/heatmap.geom", GL_GEOMETRY_SHADER);
+    assert(geomShader > 0);
+    fragShader = compile_shader("/ui/shader/heatmap/heatmap.frag", GL_FRAGMENT_SHADER);
+    assert(fragShader > 0);
+
+    // Prepare program:
+    glAttachShader(shaderProg, vertShader);
+    glAttachShader(shaderProg, geomShader);
+    glAttachShader(shaderProg, fragShader);
+    glBindFragDataLocation(shaderProg, 0, "outColor");
+    glLinkProgram(shaderProg);
+    GLERR;
+
+    // Check for errors during linking:
+    GLint status = GL_FALSE;
+    glGetProgramiv(shaderProg, GL_LINK_STATUS, &status);
+    if (status == GL_FALSE) {
+        int log_len = 0;
+        glGetProgramiv(shaderProg, GL_INFO_LOG_LENGTH, &log_len);
+
+        std::string log_msg;
+        log_msg.resize(log_len);
+        glGetProgramInfoLog(shaderProg, log_len, nullptr, static_cast<GLchar*>(log_msg.data()));
+        SPDLOG_ERROR("Linking heatmap shader program failed: {}", log_msg);
+        glDeleteProgram(shaderProg);
+        shaderProg = 0;
+    } else {
+        glDetachShader(shaderProg, fragShader);
+        glDetachShader(shaderProg, vertShader);
+        glDetachShader(shaderProg, geomShader);
+    }
+    GLERR;
+
+    // Bind attributes:
+    glUseProgram(shaderProg);
+    glUniform1i(glGetUniformLocation(shaderProg, "densityTexture"), 0);
+    saturationCountConst = glGetUniformLocation(shaderProg, "saturationCount");
+    GLERR;
+}
+
+void HeatmapGlObject::render_internal() {
+    glUniform1f(saturationCountConst, saturationCount);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, densityTexture);
+    glDrawArrays(GL_POINTS, 0, 1);
+    GLERR;
+}
+
+void HeatmapGlObject::cleanup_internal() {
+    glDeleteShader(fragShader);
+    glDeleteShader(geomShader);
+    glDeleteShader(vertShader);
+}
+}  // namespace ui::widgets::opengl
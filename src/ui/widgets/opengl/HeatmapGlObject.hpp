@@ -0,0 +1,59 @@
+#pragma once
+
+#include "AbstractGlObject.hpp"
+#include <epoxy/gl.h>
+#include <epoxy/gl_generated.h>
+#include <gtkmm/glarea.h>
+
+namespace ui::widgets::opengl {
+/**
+ * Each heatmap cell covers HEATMAP_CELL_PIXELS x HEATMAP_CELL_PIXELS screen pixels.
+ **/
+constexpr GLsizei HEATMAP_CELL_PIXELS = 4;
+/**
+ * Below this zoom factor entities get drawn as heatmap by default.
+ * At 1/8 the whole map spans 1024 screen pixels, where single entities are barely distinguishable.
+ **/
+constexpr float DEFAULT_HEATMAP_ZOOM_THRESHOLD = 1.0F / 8;
+/**
+ * Cells with HEATMAP_SATURATION_FACTOR times the number of entities a cell would get in case they were spread evenly across the map get the hottest color.
+ **/
+constexpr float HEATMAP_SATURATION_FACTOR = 32;
+
+/**
+ * Turns the entity counts per cell, accumulated by EntityGlObject::render_density(), into colors.
+ * Shades each cell once, independent of the number of entities.
+ **/
+class HeatmapGlObject : public AbstractGlObject {
+ private:
+    GLuint vertShader{0};
+    GLuint geomShader{0};
+    GLuint fragShader{0};
+
+    GLint saturationCountConst{0};
+
+    GLuint densityTexture{0};
+    float saturationCount{1};
+
+ public:
+    HeatmapGlObject() = default;
+    HeatmapGlObject(HeatmapGlObject& other) = delete;
+    HeatmapGlObject(HeatmapGlObject&& old) = delete;
+
+    ~HeatmapGlObject() override = default;
+
+    HeatmapGlObject& operator=(HeatmapGlObject& other) = delete;
+    HeatmapGlObject& operator=(HeatmapGlObject&& old) = delete;
+
+    void bind_texture(GLuint densityTexture);
+    /**
+     * Number of entities per cell that maps to the hottest color.
+     **/
+    void set_saturation_count(float saturationCount);
+
+ protected:
+    void init_internal() override;
+    void render_internal() override;
+    void cleanup_internal() override;
+};
+}  // namespace ui::widgets::opengl
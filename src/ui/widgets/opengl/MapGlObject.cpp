@@ -1,9 +1,11 @@
 
 #include "MapGlObject.hpp"
-#include "sim/Entity.hpp"
 #include "sim/Map.hpp"
 #include "sim/Simulator.hpp"
 #include <cassert>
+#include <cstddef>
+#include <optional>
+#include <epoxy/gl_generated.h>
 
 namespace ui::widgets::opengl {
 void MapGlObject::init_internal() {
@@ -12,7 +14,10 @@ void MapGlObject::init_internal() {
     assert(map);
 
     // Vertex data:
-    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(sim::RoadPiece) * map->roadPieces.size()), static_cast<void*>(map->roadPieces.data()), GL_DYNAMIC_DRAW);
+    // The road geometry never changes, so upload it once into an immutable buffer.
+    // Each road consists of two coordinates, so vertex i belongs to road i / 2:
+    static_assert(sizeof(sim::Road) == sizeof(sim::Coordinate) * 2, "Roads are expected to consist of exactly two coordinates.");
+    glBufferStorage(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(sim::Road) * map->roads.size()), static_cast<const void*>(map->roads.data()), 0);
     GLERR;
 
     // Compile shader:
@@ -49,18 +54,9 @@ void MapGlObject::init_internal() {
 
     // Bind attributes:
     glUseProgram(shaderProg);
-    GLint colAttrib = glGetAttribLocation(shaderProg, "color");
-    GLERR;
-    glEnableVertexAttribArray(colAttrib);
-    GLERR;
-    // NOLINTNEXTLINE (cppcoreguidelines-pro-type-reinterpret-cast)
-    glVertexAttribPointer(colAttrib, 4, GL_FLOAT, GL_FALSE, sizeof(sim::RoadPiece), reinterpret_cast<void*>(2 * sizeof(sim::Vec2)));
-    GLERR;
-
     GLint posAttrib = glGetAttribLocation(shaderProg, "position");
     glEnableVertexAttribArray(posAttrib);
-    // NOLINTNEXTLINE (cppcoreguidelines-pro-type-reinterpret-cast)
-    glVertexAttribPointer(posAttrib, 2, GL_FLOAT, GL_FALSE, sizeof(sim::RoadPiece), nullptr);
+    glVertexAttribPointer(posAttrib, 2, GL_FLOAT, GL_FALSE, sizeof(sim::Coordinate), nullptr);
     GLERR;
 
     GLint worldSizeConst = glGetUniformLocation(shaderProg, "worldSize");
@@ -71,16 +67,18 @@ void MapGlObject::init_internal() {
 
 void MapGlObject::render_internal() {
     assert(simulator);
-    const std::shared_ptr<sim::Map> map = simulator->get_map();
-    assert(map);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(sizeof(sim::RoadPiece) * map->roadPieces.size()), static_cast<void*>(map->roadPieces.data()));
+    const std::optional<size_t> selectedRoad = simulator->get_map()->selectedRoad;
+    if (!selectedRoad) {
+        return;
+    }
 
+    // The unselected roads are part of the map tiles, so only draw the selected one:
     glLineWidth(1);
-    glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(simulator->get_map()->roadPieces.size()));
+    glDrawArrays(GL_LINES, static_cast<GLint>(*selectedRoad * 2), 2);
 }
 
 void MapGlObject::cleanup_internal() {
     glDeleteShader(fragShader);
-    glDeleteShader(fragShader);
+    glDeleteShader(vertShader);
 }
 }  // namespace ui::widgets::opengl
\ No newline at end of file
@@ -1,9 +1,13 @@
 #pragma once
 
 #include "AbstractGlObject.hpp"
+#include "sim/Entity.hpp"
 #include <epoxy/gl.h>
 
 namespace ui::widgets::opengl {
+/**
+ * Draws the selected road on top of the map tiles.
+ **/
 class MapGlObject : public AbstractGlObject {
  private:
     GLuint vertShader{0};
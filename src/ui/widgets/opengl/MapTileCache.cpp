@@ -0,0 +1,185 @@
+#include "MapTileCache.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <thread>
+#include <utility>
+
+namespace ui::widgets::opengl::tiles {
+namespace {
+/**
+ * Upper bound for the number of threads preparing tile geometry.
+ **/
+constexpr size_t MAX_TILE_WORKERS = 4;
+
+/**
+ * Returns the first and last tile index along one axis overlapping [min, max] at the given level.
+ **/
+std::pair<uint32_t, uint32_t> calc_tile_range(float min, float max, uint32_t level) {
+    const uint32_t tileCount = 1U << level;
+    auto toTile = [tileCount](float pos) {
+        return std::min(static_cast<uint32_t>(std::max(pos, 0.0F) * static_cast<float>(tileCount)), tileCount - 1);
+    };
+    return {toTile(min), toTile(max)};
+}
+
+size_t calc_visible_tile_count(const TileView& view) {
+    const auto [minX, maxX] = calc_tile_range(view.min.x, view.max.x, view.level);
+    const auto [minY, maxY] = calc_tile_range(view.min.y, view.max.y, view.level);
+    return static_cast<size_t>(maxX - minX + 1) * (maxY - minY + 1);
+}
+}  // namespace
+
+TileView calc_tile_view(const Camera& camera) {
+    TileView view;
+    const sim::Vec2 visibleMin = camera.get_visible_min();
+    const sim::Vec2 visibleMax = camera.get_visible_max();
+    view.min = {std::clamp(visibleMin.x, 0.0F, 1.0F), std::clamp(visibleMin.y, 0.0F, 1.0F)};
+    view.max = {std::clamp(visibleMax.x, 0.0F, 1.0F), std::clamp(visibleMax.y, 0.0F, 1.0F)};
+
+    // Round down, so a tile never covers less than TILE_SIZE screen pixels and the visible tile count stays bounded by the viewport size:
+    const float level = std::floor(std::log2(camera.get_map_pixels() / static_cast<float>(TILE_SIZE)));
+    view.level = static_cast<uint32_t>(std::clamp(level, 0.0F, static_cast<float>(MAX_TILE_LEVEL)));
+
+    // Large viewports would still require more tiles than the atlas can hold at once:
+    while (view.level > 0 && calc_visible_tile_count(view) > MAX_VISIBLE_TILES) {
+        view.level--;
+    }
+    return view;
+}
+
+void MapTileCache::start(std::shared_ptr<sim::Map> map) {
+    const size_t workerCount = std::clamp(static_cast<size_t>(std::thread::hardware_concurrency()) / 2, static_cast<size_t>(1), MAX_TILE_WORKERS);
+    workerPool.start(std::move(map), workerCount);
+}
+
+void MapTileCache::stop() {
+    workerPool.stop();
+    slots.fill(Slot{});
+    slotIndices.clear();
+    ready.clear();
+    visibleKeys.clear();
+}
+
+std::optional<size_t> MapTileCache::lookup(const TileKey& key) {
+    auto iter = slotIndices.find(key);
+    if (iter == slotIndices.end()) {
+        return std::nullopt;
+    }
+    slots[iter->second].lastUsedFrame = frame;
+    return iter->second;
+}
+
+std::optional<size_t> MapTileCache::acquire_slot() {
+    size_t result = 0;
+    for (size_t i = 1; i < slots.size(); i++) {
+        if (slots[i].lastUsedFrame < slots[result].lastUsedFrame) {
+            result = i;
+        }
+    }
+
+    // Never evict tiles visible during the current frame:
+    if (slots[result].lastUsedFrame >= frame) {
+        return std::nullopt;
+    }
+    if (slots[result].key) {
+        slotIndices.erase(*slots[result].key);
+        slots[result].key = std::nullopt;
+    }
+    return result;
+}
+
+std::array<float, 4> MapTileCache::calc_atlas_rect(size_t slot, const TileKey& slotKey, const TileKey& key) {
+    assert(slotKey.level <= key.level);
+
+    // Part of the slot tile covered by the requested tile:
+    const float subTiles = std::ldexp(1.0F, static_cast<int>(key.level - slotKey.level));
+    const float subX = static_cast<float>(key.x - (slotKey.x << (key.level - slotKey.level))) / subTiles;
+    const float subY = static_cast<float>(key.y - (slotKey.y << (key.level - slotKey.level))) / subTiles;
+
+    const float slotX = static_cast<float>(slot % ATLAS_SLOTS_X);
+    const float slotY = static_cast<float>(slot / ATLAS_SLOTS_X);
+    return {(slotX + subX) / ATLAS_SLOTS_X,
+            (slotY + subY) / ATLAS_SLOTS_Y,
+            (slotX + subX + (1 / subTiles)) / ATLAS_SLOTS_X,
+            (slotY + subY + (1 / subTiles)) / ATLAS_SLOTS_Y};
+}
+
+std::vector<TileQuad> MapTileCache::prepare_view(const TileView& view) {
+    frame++;
+    visibleKeys.clear();
+
+    // The root tile is always kept as the last resort fallback:
+    const TileKey root{};
+    visibleKeys.insert(root);
+    if (!lookup(root)) {
+        workerPool.request(root);
+    }
+
+    std::vector<TileQuad> quads;
+    const float tileSize = 1.0F / static_cast<float>(1U << view.level);
+    const auto [minX, maxX] = calc_tile_range(view.min.x, view.max.x, view.level);
+    const auto [minY, maxY] = calc_tile_range(view.min.y, view.max.y, view.level);
+    for (uint32_t y = minY; y <= maxY; y++) {
+        for (uint32_t x = minX; x <= maxX; x++) {
+            const TileKey key{view.level, x, y};
+            visibleKeys.insert(key);
+            std::optional<size_t> slot = lookup(key);
+            TileKey slotKey = key;
+            if (!slot) {
+                workerPool.request(key);
+
+                // Fall back to the closest cached ancestor:
+                for (uint32_t level = key.level; level-- > 0 && !slot;) {
+                    slotKey = key.ancestor(level);
+                    slot = lookup(slotKey);
+                }
+                if (!slot) {
+                    continue;
+                }
+            }
+
+            TileQuad& quad = quads.emplace_back();
+            const float minU = static_cast<float>(x) * tileSize;
+            const float minV = static_cast<float>(y) * tileSize;
+            quad.mapRect = {minU, minV, minU + tileSize, minV + tileSize};
+            quad.atlasRect = calc_atlas_rect(*slot, slotKey, key);
+        }
+    }
+    return quads;
+}
+
+std::vector<TileUpload> MapTileCache::take_uploads() {
+    for (TileGeometry& geometry : workerPool.fetch_results()) {
+        ready.push_back(std::move(geometry));
+    }
+    // Tiles of previous views would only take the slots of visible ones and might never get one:
+    std::erase_if(ready, [this](const TileGeometry& geometry) { return slotIndices.contains(geometry.key) || !visibleKeys.contains(geometry.key); });
+
+    std::vector<TileUpload> uploads;
+    // Latest results first, since they most likely belong to the current view:
+    while (!ready.empty() && uploads.size() < MAX_TILE_UPLOADS_PER_FRAME) {
+        // The same tile might have been prepared twice:
+        if (slotIndices.contains(ready.back().key)) {
+            ready.pop_back();
+            continue;
+        }
+
+        // MAX_VISIBLE_TILES ensures a slot becomes free with the next frame in case a visible tile is missing:
+        std::optional<size_t> slot = acquire_slot();
+        if (!slot) {
+            break;
+        }
+        slots[*slot].key = ready.back().key;
+        slots[*slot].lastUsedFrame = frame;
+        slotIndices[ready.back().key] = *slot;
+        uploads.push_back(TileUpload{std::move(ready.back()), *slot});
+        ready.pop_back();
+    }
+    return uploads;
+}
+
+bool MapTileCache::has_pending() {
+    return !ready.empty() || workerPool.has_pending();
+}
+}  // namespace ui::widgets::opengl::tiles
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "Camera.hpp"
+#include "MapTileGeometry.hpp"
+#include "sim/Map.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace ui::widgets::opengl::tiles {
+/**
+ * The atlas consists of ATLAS_SLOTS_X x ATLAS_SLOTS_Y tiles.
+ * This bounds the GPU memory used for the map independent of the map size.
+ **/
+constexpr uint32_t ATLAS_SLOTS_X = 8;
+constexpr uint32_t ATLAS_SLOTS_Y = 8;
+constexpr uint32_t ATLAS_SIZE_X = ATLAS_SLOTS_X * TILE_SIZE;
+constexpr uint32_t ATLAS_SIZE_Y = ATLAS_SLOTS_Y * TILE_SIZE;
+
+/**
+ * Max number of tiles calc_tile_view() selects a level for.
+ * Together with the root tile and one fallback ancestor there is always a slot left for a missing visible tile.
+ **/
+constexpr size_t MAX_VISIBLE_TILES = (static_cast<size_t>(ATLAS_SLOTS_X) * ATLAS_SLOTS_Y) - 2;
+
+/**
+ * Max number of tiles that get rasterized into the atlas per frame to keep frame times stable.
+ **/
+constexpr size_t MAX_TILE_UPLOADS_PER_FRAME = 4;
+
+/**
+ * The part of the map currently visible on screen.
+ **/
+struct TileView {
+    /**
+     * Visible map rect normalized to [0, 1].
+     **/
+    sim::Vec2 min{};
+    sim::Vec2 max{};
+    uint32_t level{0};
+};
+
+/**
+ * A single tile (or part of one) that should be drawn on screen.
+ **/
+struct TileQuad {
+    /**
+     * minX, minY, maxX, maxY in normalized map coordinates.
+     * Gets transformed to the screen by the camera inside the shader.
+     **/
+    std::array<float, 4> mapRect{};
+    /**
+     * minX, minY, maxX, maxY in atlas texture coordinates.
+     **/
+    std::array<float, 4> atlasRect{};
+} __attribute__((packed)) __attribute__((aligned(4)));
+
+/**
+ * A tile that is ready to be rasterized into the given atlas slot.
+ **/
+struct TileUpload {
+    TileGeometry geometry;
+    size_t slot{0};
+};
+
+/**
+ * Calculates the part of the map visible through the given camera and the tile level required to draw it with at most one tile pixel per screen pixel.
+ * Falls back to coarser levels in case the view would require more than MAX_VISIBLE_TILES tiles.
+ **/
+TileView calc_tile_view(const Camera& camera);
+
+/**
+ * Keeps track of which tiles are stored in which atlas slot and evicts the least recently used ones.
+ * Tile geometry gets prepared in the background by a TileWorkerPool.
+ * Does not issue any OpenGL calls by itself.
+ **/
+class MapTileCache {
+ private:
+    struct Slot {
+        std::optional<TileKey> key{std::nullopt};
+        uint64_t lastUsedFrame{0};
+    };
+
+    TileWorkerPool workerPool;
+
+    std::array<Slot, static_cast<size_t>(ATLAS_SLOTS_X) * ATLAS_SLOTS_Y> slots{};
+    std::unordered_map<TileKey, size_t, TileKeyHash> slotIndices;
+    /**
+     * Prepared tiles that exceeded MAX_TILE_UPLOADS_PER_FRAME.
+     **/
+    std::vector<TileGeometry> ready;
+    /**
+     * All tiles requested by the last prepare_view() call. Prepared tiles not in here get dropped instead of uploaded.
+     **/
+    std::unordered_set<TileKey, TileKeyHash> visibleKeys;
+
+    uint64_t frame{1};
+
+    std::optional<size_t> lookup(const TileKey& key);
+    std::optional<size_t> acquire_slot();
+    [[nodiscard]] static std::array<float, 4> calc_atlas_rect(size_t slot, const TileKey& slotKey, const TileKey& key);
+
+ public:
+    MapTileCache() = default;
+    MapTileCache(MapTileCache& other) = delete;
+    MapTileCache(MapTileCache&& old) = delete;
+
+    ~MapTileCache() = default;
+
+    MapTileCache& operator=(MapTileCache& other) = delete;
+    MapTileCache& operator=(MapTileCache&& old) = delete;
+
+    void start(std::shared_ptr<sim::Map> map);
+    void stop();
+
+    /**
+     * Starts a new frame and returns all quads required to draw the given view.
+     * Tiles that are not cached yet get requested and are replaced by the closest cached ancestor in the meantime.
+     **/
+    std::vector<TileQuad> prepare_view(const TileView& view);
+
+    /**
+     * Returns up to MAX_TILE_UPLOADS_PER_FRAME prepared tiles together with the atlas slot they should be rasterized to.
+     * Only slots not used by the current frame get evicted.
+     * Prepared tiles the last prepare_view() call did not request anymore get dropped. They get prepared again once they become visible.
+     **/
+    std::vector<TileUpload> take_uploads();
+
+    /**
+     * True in case there are tiles that still have to be prepared or rasterized.
+     **/
+    [[nodiscard]] bool has_pending();
+};
+}  // namespace ui::widgets::opengl::tiles
@@ -0,0 +1,138 @@
+#include "MapTileGeometry.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <utility>
+
+namespace ui::widgets::opengl::tiles {
+TileKey TileKey::ancestor(uint32_t ancestorLevel) const {
+    assert(ancestorLevel <= level);
+    const uint32_t shift = level - ancestorLevel;
+    return TileKey{ancestorLevel, x >> shift, y >> shift};
+}
+
+size_t TileKeyHash::operator()(const TileKey& key) const {
+    // Levels are small, so pack everything into one value:
+    const uint64_t packed = (static_cast<uint64_t>(key.level) << 56) | (static_cast<uint64_t>(key.x) << 28) | key.y;
+    return std::hash<uint64_t>{}(packed);
+}
+
+TileGeometry build_tile_geometry(const sim::Map& map, const TileKey& key) {
+    TileGeometry geometry{key, {}};
+
+    const float tileCount = std::ldexp(1.0F, static_cast<int>(key.level));
+    const float tileWidth = map.width / tileCount;
+    const float tileHeight = map.height / tileCount;
+    const sim::Vec2 min{static_cast<float>(key.x) * tileWidth, static_cast<float>(key.y) * tileHeight};
+    const sim::Vec2 max{min.x + tileWidth, min.y + tileHeight};
+
+    // Transforms the given position to tile pixel coordinates:
+    auto toPixel = [&](const sim::Vec2& pos) {
+        return std::pair<int32_t, int32_t>{static_cast<int32_t>(std::lround(((pos.x - min.x) / tileWidth) * TILE_SIZE)), static_cast<int32_t>(std::lround(((pos.y - min.y) / tileHeight) * TILE_SIZE))};
+    };
+    auto toTileLocal = [](int32_t pixel) {
+        return ((static_cast<float>(pixel) / static_cast<float>(TILE_SIZE)) * 2) - 1;
+    };
+
+    // Unique lines in pixel space. Direction does not matter:
+    std::unordered_set<uint64_t> lines;
+    for (size_t roadIndex : map.roads_in_rect(min, max)) {
+        const sim::Road& road = map.roads[roadIndex];
+        auto [x0, y0] = toPixel(road.start.pos);
+        auto [x1, y1] = toPixel(road.end.pos);
+        if (x0 == x1 && y0 == y1) {
+            continue;
+        }
+
+        // Roads crossing the tile border might exceed the 16 bit range, but they are rare enough to not bother:
+        auto pack = [](int32_t x, int32_t y) { return (static_cast<uint64_t>(static_cast<uint16_t>(x)) << 16) | static_cast<uint16_t>(y); };
+        const uint64_t a = pack(x0, y0);
+        const uint64_t b = pack(x1, y1);
+        if (!lines.insert((std::min(a, b) << 32) | std::max(a, b)).second) {
+            continue;
+        }
+
+        geometry.vertices.push_back(sim::Vec2{toTileLocal(x0), toTileLocal(y0)});
+        geometry.vertices.push_back(sim::Vec2{toTileLocal(x1), toTileLocal(y1)});
+    }
+    return geometry;
+}
+
+TileWorkerPool::~TileWorkerPool() {
+    stop();
+}
+
+void TileWorkerPool::start(std::shared_ptr<sim::Map> map, size_t workerCount) {
+    assert(workers.empty());
+    this->map = std::move(map);
+    shouldStop = false;
+    for (size_t i = 0; i < std::max(workerCount, static_cast<size_t>(1)); i++) {
+        workers.emplace_back(&TileWorkerPool::worker, this);
+    }
+}
+
+void TileWorkerPool::stop() {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        shouldStop = true;
+        jobs.clear();
+        pending.clear();
+        results.clear();
+    }
+    jobsCondition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+void TileWorkerPool::request(const TileKey& key) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!pending.insert(key).second) {
+            return;
+        }
+        jobs.push_back(key);
+    }
+    jobsCondition.notify_one();
+}
+
+bool TileWorkerPool::has_pending() {
+    std::unique_lock<std::mutex> lock(mutex);
+    return !pending.empty();
+}
+
+std::vector<TileGeometry> TileWorkerPool::fetch_results() {
+    std::unique_lock<std::mutex> lock(mutex);
+    std::vector<TileGeometry> result = std::move(results);
+    results.clear();
+    for (const TileGeometry& geometry : result) {
+        pending.erase(geometry.key);
+    }
+    return result;
+}
+
+void TileWorkerPool::worker() {
+    while (true) {
+        TileKey key;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobsCondition.wait(lock, [this]() { return shouldStop || !jobs.empty(); });
+            if (shouldStop) {
+                return;
+            }
+            // Latest requests first, since they belong to the current view:
+            key = jobs.back();
+            jobs.pop_back();
+        }
+
+        TileGeometry geometry = build_tile_geometry(*map, key);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        if (shouldStop) {
+            return;
+        }
+        results.push_back(std::move(geometry));
+    }
+}
+}  // namespace ui::widgets::opengl::tiles
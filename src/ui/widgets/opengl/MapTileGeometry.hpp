@@ -0,0 +1,104 @@
+#pragma once
+
+#include "sim/Map.hpp"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace ui::widgets::opengl::tiles {
+/**
+ * Width and height of a single tile in pixels.
+ **/
+constexpr uint32_t TILE_SIZE = 512;
+/**
+ * At level l the map gets split into 2^l x 2^l tiles.
+ **/
+constexpr uint32_t MAX_TILE_LEVEL = 7;
+
+struct TileKey {
+    uint32_t level{0};
+    uint32_t x{0};
+    uint32_t y{0};
+
+    bool operator==(const TileKey& other) const = default;
+
+    /**
+     * Returns the tile at the given coarser level that covers this tile.
+     **/
+    [[nodiscard]] TileKey ancestor(uint32_t ancestorLevel) const;
+};
+
+struct TileKeyHash {
+    size_t operator()(const TileKey& key) const;
+};
+
+/**
+ * Line vertices of all roads inside a tile, already transformed to the tile local range [-1, 1].
+ **/
+struct TileGeometry {
+    TileKey key{};
+    std::vector<sim::Vec2> vertices;
+};
+
+/**
+ * Collects all roads intersecting the given tile and simplifies them for the tile resolution.
+ * Road end points get snapped to the tile pixel grid, so roads shorter than a pixel and duplicate lines get dropped.
+ * At low levels this removes most of the roads.
+ **/
+TileGeometry build_tile_geometry(const sim::Map& map, const TileKey& key);
+
+/**
+ * Pool of CPU workers that prepare the geometry of requested tiles in the background.
+ **/
+class TileWorkerPool {
+ private:
+    std::shared_ptr<sim::Map> map{nullptr};
+
+    std::mutex mutex;
+    std::condition_variable jobsCondition;
+    std::deque<TileKey> jobs;
+    /**
+     * All tiles that have been requested but not fetched yet.
+     **/
+    std::unordered_set<TileKey, TileKeyHash> pending;
+    std::vector<TileGeometry> results;
+    bool shouldStop{false};
+
+    std::vector<std::thread> workers;
+
+    void worker();
+
+ public:
+    TileWorkerPool() = default;
+    TileWorkerPool(TileWorkerPool& other) = delete;
+    TileWorkerPool(TileWorkerPool&& old) = delete;
+
+    ~TileWorkerPool();
+
+    TileWorkerPool& operator=(TileWorkerPool& other) = delete;
+    TileWorkerPool& operator=(TileWorkerPool&& old) = delete;
+
+    void start(std::shared_ptr<sim::Map> map, size_t workerCount);
+    void stop();
+
+    /**
+     * Queues the given tile in case it is not already pending.
+     **/
+    void request(const TileKey& key);
+    /**
+     * True in case there are requested tiles that have not been fetched yet.
+     **/
+    [[nodiscard]] bool has_pending();
+
+    /**
+     * Returns all tiles that have been prepared since the last call.
+     **/
+    std::vector<TileGeometry> fetch_results();
+};
+}  // namespace ui::widgets::opengl::tiles
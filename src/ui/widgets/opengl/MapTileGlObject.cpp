@@ -0,0 +1,85 @@
+#include "MapTileGlObject.hpp"
+#include <cassert>
+#include <epoxy/gl_generated.h>
+
+namespace ui::widgets::opengl {
+void MapTileGlObject::bind_texture(GLuint atlasTexture) {
+    this->atlasTexture = atlasTexture;
+}
+
+void MapTileGlObject::set_quads(const std::vector<tiles::TileQuad>& quads) {
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    // Only a few dozen quads per frame, so simply respecify the buffer:
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(tiles::TileQuad) * quads.size()), static_cast<const void*>(quads.data()), GL_STREAM_DRAW);
+    quadCount = static_cast<GLsizei>(quads.size());
+    GLERR;
+}
+
+void MapTileGlObject::init_internal() {
+    // Vertex data:
+    glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_STREAM_DRAW);
+    GLERR;
+
+    // Compile shader:
+    vertShader = compile_shader("/ui/shader/map/map_tile_view.vert", GL_VERTEX_SHADER);
+    assert(vertShader > 0);
+    geomShader = compile_shader("/ui/shader/map/map_tile_view.geom", GL_GEOMETRY_SHADER);
+    assert(geomShader > 0);
+    fragShader = compile_shader("/ui/shader/map/map_tile_view.frag", GL_FRAGMENT_SHADER);
+    assert(fragShader > 0);
+
+    // Prepare program:
+    glAttachShader(shaderProg, vertShader);
+    glAttachShader(shaderProg, geomShader);
+    glAttachShader(shaderProg, fragShader);
+    glBindFragDataLocation(shaderProg, 0, "outColor");
+    glLinkProgram(shaderProg);
+    GLERR;
+
+    // Check for errors during linking:
+    GLint status = GL_FALSE;
+    glGetProgramiv(shaderProg, GL_LINK_STATUS, &status);
+    if (status == GL_FALSE) {
+        int log_len = 0;
+        glGetProgramiv(shaderProg, GL_INFO_LOG_LENGTH, &log_len);
+
+        std::string log_msg;
+        log_msg.resize(log_len);
+        glGetProgramInfoLog(shaderProg, log_len, nullptr, static_cast<GLchar*>(log_msg.data()));
+        SPDLOG_ERROR("Linking map tile shader program failed: {}", log_msg);
+        glDeleteProgram(shaderProg);
+        shaderProg = 0;
+    } else {
+        glDetachShader(shaderProg, fragShader);
+        glDetachShader(shaderProg, vertShader);
+        glDetachShader(shaderProg, geomShader);
+    }
+    GLERR;
+
+    // Bind attributes:
+    glUseProgram(shaderProg);
+    GLint mapRectAttrib = glGetAttribLocation(shaderProg, "mapRect");
+    glEnableVertexAttribArray(mapRectAttrib);
+    glVertexAttribPointer(mapRectAttrib, 4, GL_FLOAT, GL_FALSE, sizeof(tiles::TileQuad), nullptr);
+    GLint atlasRectAttrib = glGetAttribLocation(shaderProg, "atlasRect");
+    glEnableVertexAttribArray(atlasRectAttrib);
+    // NOLINTNEXTLINE (cppcoreguidelines-pro-type-reinterpret-cast)
+    glVertexAttribPointer(atlasRectAttrib, 4, GL_FLOAT, GL_FALSE, sizeof(tiles::TileQuad), reinterpret_cast<void*>(sizeof(float) * 4));
+    GLERR;
+
+    glUniform1i(glGetUniformLocation(shaderProg, "atlasTexture"), 0);
+    GLERR;
+}
+
+void MapTileGlObject::render_internal() {
+    glBindTextures(0, 1, &atlasTexture);
+    glDrawArrays(GL_POINTS, 0, quadCount);
+    GLERR;
+}
+
+void MapTileGlObject::cleanup_internal() {
+    glDeleteShader(fragShader);
+    glDeleteShader(geomShader);
+    glDeleteShader(vertShader);
+}
+}  // namespace ui::widgets::opengl
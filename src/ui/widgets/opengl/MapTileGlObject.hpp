@@ -0,0 +1,39 @@
+#pragma once
+
+#include "AbstractGlObject.hpp"
+#include "MapTileCache.hpp"
+#include <vector>
+#include <epoxy/gl.h>
+
+namespace ui::widgets::opengl {
+/**
+ * Draws the visible map tiles from the tile atlas to the screen.
+ **/
+class MapTileGlObject : public AbstractGlObject {
+ private:
+    GLuint vertShader{0};
+    GLuint geomShader{0};
+    GLuint fragShader{0};
+
+    GLuint atlasTexture{0};
+    GLsizei quadCount{0};
+
+ public:
+    MapTileGlObject() = default;
+    MapTileGlObject(MapTileGlObject& other) = delete;
+    MapTileGlObject(MapTileGlObject&& old) = delete;
+
+    ~MapTileGlObject() override = default;
+
+    MapTileGlObject& operator=(MapTileGlObject& other) = delete;
+    MapTileGlObject& operator=(MapTileGlObject&& old) = delete;
+
+    void bind_texture(GLuint atlasTexture);
+    void set_quads(const std::vector<tiles::TileQuad>& quads);
+
+ protected:
+    void init_internal() override;
+    void render_internal() override;
+    void cleanup_internal() override;
+};
+}  // namespace ui::widgets::opengl
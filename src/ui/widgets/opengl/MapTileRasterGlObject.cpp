@@ -0,0 +1,82 @@
+#include "MapTileRasterGlObject.hpp"
+#include "MapTileGeometry.hpp"
+#include <cassert>
+#include <epoxy/gl_generated.h>
+
+namespace ui::widgets::opengl {
+void MapTileRasterGlObject::set_upload(const tiles::TileUpload* upload) {
+    this->upload = upload;
+}
+
+void MapTileRasterGlObject::init_internal() {
+    // Vertex data:
+    glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_STREAM_DRAW);
+    GLERR;
+
+    // Compile shader:
+    vertShader = compile_shader("/ui/shader/map/map_tile.vert", GL_VERTEX_SHADER);
+    assert(vertShader > 0);
+    fragShader = compile_shader("/ui/shader/map/map.frag", GL_FRAGMENT_SHADER);
+    assert(fragShader > 0);
+
+    // Prepare program:
+    glAttachShader(shaderProg, vertShader);
+    glAttachShader(shaderProg, fragShader);
+    glBindFragDataLocation(shaderProg, 0, "outColor");
+    glLinkProgram(shaderProg);
+    GLERR;
+
+    // Check for errors during linking:
+    GLint status = GL_FALSE;
+    glGetProgramiv(shaderProg, GL_LINK_STATUS, &status);
+    if (status == GL_FALSE) {
+        int log_len = 0;
+        glGetProgramiv(shaderProg, GL_INFO_LOG_LENGTH, &log_len);
+
+        std::string log_msg;
+        log_msg.resize(log_len);
+        glGetProgramInfoLog(shaderProg, log_len, nullptr, static_cast<GLchar*>(log_msg.data()));
+        SPDLOG_ERROR("Linking map tile raster shader program failed: {}", log_msg);
+        glDeleteProgram(shaderProg);
+        shaderProg = 0;
+    } else {
+        glDetachShader(shaderProg, fragShader);
+        glDetachShader(shaderProg, vertShader);
+    }
+    GLERR;
+
+    // Bind attributes:
+    glUseProgram(shaderProg);
+    GLint posAttrib = glGetAttribLocation(shaderProg, "position");
+    glEnableVertexAttribArray(posAttrib);
+    glVertexAttribPointer(posAttrib, 2, GL_FLOAT, GL_FALSE, sizeof(sim::Vec2), nullptr);
+    GLERR;
+}
+
+void MapTileRasterGlObject::render_internal() {
+    assert(upload);
+    const std::vector<sim::Vec2>& vertices = upload->geometry.vertices;
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(sim::Vec2) * vertices.size()), static_cast<const void*>(vertices.data()), GL_STREAM_DRAW);
+    GLERR;
+
+    // Restrict drawing to the atlas slot of the tile:
+    const auto slotX = static_cast<GLint>((upload->slot % tiles::ATLAS_SLOTS_X) * tiles::TILE_SIZE);
+    const auto slotY = static_cast<GLint>((upload->slot / tiles::ATLAS_SLOTS_X) * tiles::TILE_SIZE);
+    glViewport(slotX, slotY, tiles::TILE_SIZE, tiles::TILE_SIZE);
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(slotX, slotY, tiles::TILE_SIZE, tiles::TILE_SIZE);
+    glClearColor(0, 0, 0, 0);
+    glClear(GL_COLOR_BUFFER_BIT);
+    GLERR;
+
+    glLineWidth(1);
+    glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(vertices.size()));
+    glDisable(GL_SCISSOR_TEST);
+    GLERR;
+}
+
+void MapTileRasterGlObject::cleanup_internal() {
+    glDeleteShader(fragShader);
+    glDeleteShader(vertShader);
+}
+}  // namespace ui::widgets::opengl
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "AbstractGlObject.hpp"
+#include "MapTileCache.hpp"
+#include <epoxy/gl.h>
+
+namespace ui::widgets::opengl {
+/**
+ * Rasterizes prepared map tiles into their slot of the tile atlas.
+ **/
+class MapTileRasterGlObject : public AbstractGlObject {
+ private:
+    GLuint vertShader{0};
+    GLuint fragShader{0};
+
+    const tiles::TileUpload* upload{nullptr};
+
+ public:
+    MapTileRasterGlObject() = default;
+    MapTileRasterGlObject(MapTileRasterGlObject& other) = delete;
+    MapTileRasterGlObject(MapTileRasterGlObject&& old) = delete;
+
+    ~MapTileRasterGlObject() override = default;
+
+    MapTileRasterGlObject& operator=(MapTileRasterGlObject& other) = delete;
+    MapTileRasterGlObject& operator=(MapTileRasterGlObject&& old) = delete;
+
+    /**
+     * Sets the tile the next render() call rasterizes.
+     * Expects the tile atlas frame buffer to be bound while rendering.
+     **/
+    void set_upload(const tiles::TileUpload* upload);
+
+ protected:
+    void init_internal() override;
+    void render_internal() override;
+    void cleanup_internal() override;
+};
+}  // namespace ui::widgets::opengl
@@ -7,47 +7,42 @@
 #include <epoxy/gl_generated.h>
 
 namespace ui::widgets::opengl {
-void QuadTreeGridGlObject::set_quad_tree_nodes(const std::shared_ptr<std::vector<sim::gpu_quad_tree::Node>>& nodes) {
-    // Transform to points:
-    vertices.clear();
-    GLsizei newVerticesCount = 0;
-    add_node_rec(nodes, (*nodes)[0], newVerticesCount);
-    bool sameSize = newVerticesCount == verticesCount;
-
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+void QuadTreeGridGlObject::set_quad_tree_nodes(const std::vector<sim::gpu_quad_tree::Node>& nodes) {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, vbo);
     GLERR;
 
-    // Only change the buffer size in case the number of elements actually changed:
-    if (sameSize) {
-        glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(sizeof(sim::Vec2) * vertices.size()), static_cast<void*>(vertices.data()));
+    // Only change the buffer size in case the number of nodes actually changed:
+    const GLsizei newNodeCount = static_cast<GLsizei>(nodes.size());
+    if (newNodeCount == nodeCount) {
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>(sizeof(sim::gpu_quad_tree::Node) * nodes.size()), nodes.data());
     } else {
-        verticesCount = newVerticesCount;
-        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(sim::Vec2) * vertices.size()), static_cast<void*>(vertices.data()), GL_DYNAMIC_DRAW);
+        nodeCount = newNodeCount;
+        glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(sizeof(sim::gpu_quad_tree::Node) * nodes.size()), nodes.data(), GL_DYNAMIC_DRAW);
     }
     GLERR;
 }
 
-void QuadTreeGridGlObject::add_node_rec(const std::shared_ptr<std::vector<sim::gpu_quad_tree::Node>>& nodes, const sim::gpu_quad_tree::Node& node, GLsizei& newVerticesCount) {
-    vertices.push_back({node.offsetX, node.offsetY});  // Top Left
-    vertices.push_back({node.offsetX + node.width, node.offsetY});  // Top Right
-
-    vertices.push_back({node.offsetX + node.width, node.offsetY});  // Top Right
-    vertices.push_back({node.offsetX + node.width, node.offsetY + node.height});  // Bottom Right
-
-    vertices.push_back({node.offsetX + node.width, node.offsetY + node.height});  // Bottom Right
-    vertices.push_back({node.offsetX, node.offsetY + node.height});  // Bottom Left
+bool QuadTreeGridGlObject::import_shared_quad_tree_nodes(const sim::gl_interop::SharedBufferHandle& handle) {
+    if (!utils::import_shared_buffer(handle, sharedMemory, sharedNodes)) {
+        return false;
+    }
+    nodeCount = static_cast<GLsizei>(handle.size / sizeof(sim::gpu_quad_tree::Node));
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, vbo);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(sizeof(sim::gpu_quad_tree::Node)) * nodeCount, nullptr, GL_DYNAMIC_COPY);
+    GLERR;
 
-    vertices.push_back({node.offsetX, node.offsetY + node.height});  // Bottom Left
-    vertices.push_back({node.offsetX, node.offsetY});  // Top Left
+    SPDLOG_INFO("Copying the quad tree nodes on the GPU from the shared Vulkan buffer.");
+    return true;
+}
 
-    newVerticesCount += 8;
+void QuadTreeGridGlObject::copy_shared_quad_tree_nodes() const {
+    assert(sharedNodes);
+    glCopyNamedBufferSubData(sharedNodes, vbo, 0, 0, static_cast<GLsizeiptr>(sizeof(sim::gpu_quad_tree::Node)) * nodeCount);
+    GLERR;
+}
 
-    if (node.contentType == sim::gpu_quad_tree::NextType::NODE) {
-        add_node_rec(nodes, (*nodes)[node.nextTL], newVerticesCount);
-        add_node_rec(nodes, (*nodes)[node.nextTR], newVerticesCount);
-        add_node_rec(nodes, (*nodes)[node.nextBL], newVerticesCount);
-        add_node_rec(nodes, (*nodes)[node.nextBR], newVerticesCount);
-    }
+GLuint QuadTreeGridGlObject::get_shared_nodes() const {
+    return sharedNodes;
 }
 
 void QuadTreeGridGlObject::init_internal() {
@@ -55,7 +50,7 @@ void QuadTreeGridGlObject::init_internal() {
     const std::shared_ptr<sim::Map> map = simulator->get_map();
     assert(map);
 
-    // Vertex data:
+    // Node data, gets bound as shader storage buffer:
     glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
     GLERR;
 
@@ -91,27 +86,35 @@ void QuadTreeGridGlObject::init_internal() {
     }
     GLERR;
 
-    // Bind attributes:
+    // Bind uniforms. There are no vertex attributes, everything gets read from the node buffer:
     glUseProgram(shaderProg);
 
-    GLint posAttrib = glGetAttribLocation(shaderProg, "position");
-    glEnableVertexAttribArray(posAttrib);
-    // NOLINTNEXTLINE (cppcoreguidelines-pro-type-reinterpret-cast)
-    glVertexAttribPointer(posAttrib, 2, GL_FLOAT, GL_FALSE, sizeof(sim::Vec2), nullptr);
-    GLERR;
-
     worldSizeConst = glGetUniformLocation(shaderProg, "worldSize");
     glUniform2f(worldSizeConst, map->width, map->height);
+
+    maxDepthConst = glGetUniformLocation(shaderProg, "maxDepth");
+    glUniform1ui(maxDepthConst, static_cast<GLuint>(sim::QUAD_TREE_MAX_DEPTH));
     GLERR;
 }
 
 void QuadTreeGridGlObject::render_internal() {
+    if (nodeCount <= 0) {
+        return;
+    }
+
+    // Four lines per node:
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, vbo);
     glLineWidth(10);
-    glDrawArrays(GL_LINES, 0, verticesCount);
+    glDrawArraysInstanced(GL_LINES, 0, 8, nodeCount);
 }
 
 void QuadTreeGridGlObject::cleanup_internal() {
+    if (sharedNodes) {
+        glDeleteBuffers(1, &sharedNodes);
+        glDeleteMemoryObjectsEXT(1, &sharedMemory);
+    }
+
     glDeleteShader(fragShader);
-    glDeleteShader(fragShader);
+    glDeleteShader(vertShader);
 }
 }  // namespace ui::widgets::opengl
\ No newline at end of file
@@ -2,22 +2,30 @@
 
 #include "AbstractGlObject.hpp"
 #include "sim/Entity.hpp"
+#include "sim/GlInterop.hpp"
 #include "sim/GpuQuadTree.hpp"
-#include <cstddef>
 #include <memory>
 #include <vector>
 #include <epoxy/gl.h>
 
 namespace ui::widgets::opengl {
+/**
+ * Draws the outline of every quad tree node straight from the node buffer.
+ * The outlines get build inside the vertex shader with one instance per node.
+ **/
 class QuadTreeGridGlObject : public AbstractGlObject {
  private:
     GLuint vertShader{0};
     GLuint fragShader{0};
 
     GLint worldSizeConst{0};
+    GLint maxDepthConst{0};
 
-    std::vector<sim::Vec2> vertices;
-    GLsizei verticesCount{0};
+    GLsizei nodeCount{0};
+
+    // Quad tree nodes imported from Vulkan. Only copied into vbo:
+    GLuint sharedMemory{0};
+    GLuint sharedNodes{0};
 
  public:
     QuadTreeGridGlObject() = default;
@@ -29,10 +37,22 @@ class QuadTreeGridGlObject : public AbstractGlObject {
     QuadTreeGridGlObject& operator=(QuadTreeGridGlObject& other) = delete;
     QuadTreeGridGlObject& operator=(QuadTreeGridGlObject&& old) = delete;
 
-    void set_quad_tree_nodes(const std::shared_ptr<std::vector<sim::gpu_quad_tree::Node>>& nodes);
-
- private:
-    void add_node_rec(const std::shared_ptr<std::vector<sim::gpu_quad_tree::Node>>& nodes, const sim::gpu_quad_tree::Node& node, GLsizei& newVerticesCount);
+    /**
+     * Uploads the given nodes as they are.
+     **/
+    void set_quad_tree_nodes(const std::vector<sim::gpu_quad_tree::Node>& nodes);
+    /**
+     * Imports the given Vulkan buffer, so copy_shared_quad_tree_nodes() can be used instead of set_quad_tree_nodes().
+     * Returns false in case the OpenGL implementation does not support importing it. In this case set_quad_tree_nodes() has to be used.
+     * Takes ownership of the file descriptor in either case.
+     **/
+    bool import_shared_quad_tree_nodes(const sim::gl_interop::SharedBufferHandle& handle);
+    /**
+     * Copies the nodes from the shared buffer on the GPU.
+     * Must only be called while holding the shared buffer, after waiting for its ready semaphore.
+     **/
+    void copy_shared_quad_tree_nodes() const;
+    [[nodiscard]] GLuint get_shared_nodes() const;
 
  protected:
     void init_internal() override;
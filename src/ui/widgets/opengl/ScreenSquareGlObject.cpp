@@ -5,12 +5,8 @@
 #include <epoxy/gl_generated.h>
 
 namespace ui::widgets::opengl {
-void ScreenSquareGlObject::set_glArea(Gtk::GLArea* glArea) {
-    this->glArea = glArea;
-}
-
-void ScreenSquareGlObject::bind_texture(GLuint mapFrameBufferTexture, GLuint entitiesFrameBufferTexture, GLuint quadTreeGridFrameBufferTexture) {
-    frameBufferTextures = {mapFrameBufferTexture, entitiesFrameBufferTexture, quadTreeGridFrameBufferTexture};
+void ScreenSquareGlObject::bind_texture(GLuint entitiesFrameBufferTexture, GLuint quadTreeGridFrameBufferTexture, GLuint trailFrameBufferTexture) {
+    frameBufferTextures = {entitiesFrameBufferTexture, quadTreeGridFrameBufferTexture, trailFrameBufferTexture};
 }
 
 void ScreenSquareGlObject::init_internal() {
@@ -52,38 +48,41 @@ void ScreenSquareGlObject::init_internal() {
 
     // Bind attributes:
     glUseProgram(shaderProg);
-    glUniform1i(glGetUniformLocation(shaderProg, "mapTexture"), 0);
-    glUniform1i(glGetUniformLocation(shaderProg, "entitiesTexture"), 1);
-    glUniform1i(glGetUniformLocation(shaderProg, "quadTreeGridTexture"), 2);
-
-    textureSizeConst = glGetUniformLocation(shaderProg, "textureSize");
-    glUniform2f(textureSizeConst, sim::MAX_RENDER_RESOLUTION_X, sim::MAX_RENDER_RESOLUTION_Y);
-
-    screenSizeConst = glGetUniformLocation(shaderProg, "screenSize");
-    assert(glArea);
-    glUniform2f(screenSizeConst, static_cast<float>(glArea->get_width()), static_cast<float>(glArea->get_height()));
+    glUniform1i(glGetUniformLocation(shaderProg, "entitiesTexture"), 0);
+    glUniform1i(glGetUniformLocation(shaderProg, "quadTreeGridTexture"), 1);
+    glUniform1i(glGetUniformLocation(shaderProg, "trailTexture"), 2);
 
     quadTreeGridVisibleConst = glGetUniformLocation(shaderProg, "quadTreeGridVisible");
     glUniform1ui(quadTreeGridVisibleConst, 0);
+    trailVisibleConst = glGetUniformLocation(shaderProg, "trailVisible");
+    glUniform1ui(trailVisibleConst, 0);
     GLERR;
 }
 
 void ScreenSquareGlObject::render_internal() {
-    assert(glArea);
-    glUniform2f(screenSizeConst, static_cast<float>(glArea->get_width()), static_cast<float>(glArea->get_height()));
     glBindTextures(0, static_cast<GLsizei>(frameBufferTextures.size()), frameBufferTextures.data());
+
+    // The shader outputs premultiplied colors that get layered on top of the map tiles:
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
     glDrawArrays(GL_POINTS, 0, 1);
+    glDisable(GL_BLEND);
     GLERR;
 }
 
 void ScreenSquareGlObject::cleanup_internal() {
     glDeleteShader(fragShader);
     glDeleteShader(geomShader);
-    glDeleteShader(fragShader);
+    glDeleteShader(vertShader);
 }
 
 void ScreenSquareGlObject::set_quad_tree_grid_visibility(bool quadTreeGridVisible) const {
     glUseProgram(shaderProg);
     glUniform1ui(quadTreeGridVisibleConst, quadTreeGridVisible ? 1 : 0);
 }
+
+void ScreenSquareGlObject::set_trail_visibility(bool trailVisible) const {
+    glUseProgram(shaderProg);
+    glUniform1ui(trailVisibleConst, trailVisible ? 1 : 0);
+}
 }  // namespace ui::widgets::opengl
\ No newline at end of file
@@ -4,7 +4,6 @@
 #include <array>
 #include <epoxy/gl.h>
 #include <epoxy/gl_generated.h>
-#include <gtkmm/glarea.h>
 
 namespace ui::widgets::opengl {
 class ScreenSquareGlObject : public AbstractGlObject {
@@ -13,20 +12,17 @@ class ScreenSquareGlObject : public AbstractGlObject {
     GLuint geomShader{0};
     GLuint fragShader{0};
 
-    GLint screenSizeConst{0};
-    GLint textureSizeConst{0};
     GLint quadTreeGridVisibleConst{0};
+    GLint trailVisibleConst{0};
 
     /**
      * All textures that should be passed to the shader.
-     * frameBufferTextures[0] is the map texture.
-     * frameBufferTextures[1] is the entities texture.
-     * frameBufferTextures[2] is the quad tree grid texture.
+     * frameBufferTextures[0] is the entities texture.
+     * frameBufferTextures[1] is the quad tree grid texture.
+     * frameBufferTextures[2] is the downsampled trail texture.
      **/
     std::array<GLuint, 3> frameBufferTextures{};
 
-    Gtk::GLArea* glArea{nullptr};
-
  public:
     ScreenSquareGlObject() = default;
     ScreenSquareGlObject(ScreenSquareGlObject& other) = delete;
@@ -37,9 +33,9 @@ class ScreenSquareGlObject : public AbstractGlObject {
     ScreenSquareGlObject& operator=(ScreenSquareGlObject& other) = delete;
     ScreenSquareGlObject& operator=(ScreenSquareGlObject&& old) = delete;
 
-    void set_glArea(Gtk::GLArea* glArea);
-    void bind_texture(GLuint mapFrameBufferTexture, GLuint entitiesFrameBufferTexture, GLuint quadTreeGridFrameBufferTexture);
+    void bind_texture(GLuint entitiesFrameBufferTexture, GLuint quadTreeGridFrameBufferTexture, GLuint trailFrameBufferTexture);
     void set_quad_tree_grid_visibility(bool quadTreeGridVisible) const;
+    void set_trail_visibility(bool trailVisible) const;
 
  protected:
     void init_internal() override;
@@ -26,9 +26,9 @@ void AbstractGlFrameBuffer::init() {
     std::array<float, 4> borderColor{0.5F, 0.5F, 0.0F, 1.0F};
     glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor.data());
     GLERR;
-    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA16, sizeX, sizeY);
+    glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, sizeX, sizeY);
     GLERR;
-    std::vector<GLubyte> emptyData(sizeX * sizeX * 4, 0);
+    std::vector<GLubyte> emptyData(static_cast<size_t>(sizeX) * sizeY * 4, 0);
     glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, sizeX, sizeY, GL_RGBA, GL_UNSIGNED_BYTE, emptyData.data());
     GLERR;
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, fbufTexture, 0);
@@ -36,7 +36,7 @@ void AbstractGlFrameBuffer::init() {
     init_internal();
 }
 
-AbstractGlFrameBuffer::AbstractGlFrameBuffer(GLsizei sizeX, GLsizei sizeY) : sizeX(sizeX), sizeY(sizeY) {}
+AbstractGlFrameBuffer::AbstractGlFrameBuffer(GLsizei sizeX, GLsizei sizeY, GLenum internalFormat) : sizeX(sizeX), sizeY(sizeY), internalFormat(internalFormat) {}
 
 void AbstractGlFrameBuffer::bind() {
     glBindFramebuffer(GL_FRAMEBUFFER, fbuf);
@@ -46,9 +46,24 @@ void AbstractGlFrameBuffer::bind() {
 
 void AbstractGlFrameBuffer::cleanup() {
     cleanup_internal();
+    glDeleteTextures(1, &fbufTexture);
+    glDeleteRenderbuffers(1, &rBuf);
     glDeleteFramebuffers(1, &fbuf);
 }
 
+bool AbstractGlFrameBuffer::resize(GLsizei sizeX, GLsizei sizeY) {
+    if (sizeX == this->sizeX && sizeY == this->sizeY) {
+        return false;
+    }
+
+    // The texture storage is immutable, so recreate everything:
+    cleanup();
+    this->sizeX = sizeX;
+    this->sizeY = sizeY;
+    init();
+    return true;
+}
+
 GLuint AbstractGlFrameBuffer::get_texture() const {
     return fbufTexture;
 }
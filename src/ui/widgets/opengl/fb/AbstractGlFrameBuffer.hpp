@@ -12,9 +12,10 @@ class AbstractGlFrameBuffer {
 
     GLsizei sizeX;
     GLsizei sizeY;
+    GLenum internalFormat;
 
  public:
-    AbstractGlFrameBuffer(GLsizei sizeX, GLsizei sizeY);
+    AbstractGlFrameBuffer(GLsizei sizeX, GLsizei sizeY, GLenum internalFormat = GL_RGBA16);
     AbstractGlFrameBuffer(AbstractGlFrameBuffer& other) = delete;
     AbstractGlFrameBuffer(AbstractGlFrameBuffer&& old) = delete;
 
@@ -32,6 +33,12 @@ class AbstractGlFrameBuffer {
     void init();
     void bind();
     void cleanup();
+    /**
+     * Reallocates the frame buffer in case the size changed and returns true in this case.
+     * The texture gets recreated, so get_texture() has to be queried again afterwards.
+     * Leaves the frame buffer bound.
+     **/
+    bool resize(GLsizei sizeX, GLsizei sizeY);
 
     [[nodiscard]] GLuint get_texture() const;
     [[nodiscard]] GLsizei get_texture_size_x() const;
@@ -1,11 +1,19 @@
 #include "EntitiesFrameBuffer.hpp"
 #include "ui/widgets/opengl/fb/AbstractGlFrameBuffer.hpp"
+#include "ui/widgets/opengl/utils/Utils.hpp"
 
 namespace ui::widgets::opengl::fb {
 
 EntitiesFrameBuffer::EntitiesFrameBuffer(GLsizei sizeX, GLsizei sizeY) : AbstractGlFrameBuffer(sizeX, sizeY) {}
 
-void EntitiesFrameBuffer::init_internal() {}
+void EntitiesFrameBuffer::init_internal() {
+    // The trail pass reads the entities at a lower resolution and averages neighbouring pixels with a single bilinear sample.
+    // Drawing them to screen samples exact texel centers, so this does not soften them:
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GLERR;
+}
 
 void EntitiesFrameBuffer::bind_internal() {}
 
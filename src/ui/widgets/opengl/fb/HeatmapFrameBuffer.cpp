@@ -0,0 +1,22 @@
+#include "HeatmapFrameBuffer.hpp"
+#include "ui/widgets/opengl/fb/AbstractGlFrameBuffer.hpp"
+#include "ui/widgets/opengl/utils/Utils.hpp"
+
+namespace ui::widgets::opengl::fb {
+
+// Counts exceed 1, so they require a float format:
+HeatmapFrameBuffer::HeatmapFrameBuffer(GLsizei sizeX, GLsizei sizeY) : AbstractGlFrameBuffer(sizeX, sizeY, GL_R32F) {}
+
+void HeatmapFrameBuffer::init_internal() {
+    // Interpolate between cells when magnifying to screen size:
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GLERR;
+}
+
+void HeatmapFrameBuffer::bind_internal() {}
+
+void HeatmapFrameBuffer::cleanup_internal() {}
+
+}  // namespace ui::widgets::opengl::fb
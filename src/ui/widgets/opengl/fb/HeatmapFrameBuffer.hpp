@@ -0,0 +1,27 @@
+#pragma once
+
+#include "AbstractGlFrameBuffer.hpp"
+#include <epoxy/gl.h>
+#include <epoxy/gl_generated.h>
+
+namespace ui::widgets::opengl::fb {
+/**
+ * Single channel float frame buffer the number of entities per heatmap cell gets accumulated in.
+ **/
+class HeatmapFrameBuffer : public AbstractGlFrameBuffer {
+ public:
+    HeatmapFrameBuffer(GLsizei sizeX, GLsizei sizeY);
+    HeatmapFrameBuffer(HeatmapFrameBuffer& other) = delete;
+    HeatmapFrameBuffer(HeatmapFrameBuffer&& old) = delete;
+
+    ~HeatmapFrameBuffer() override = default;
+
+    HeatmapFrameBuffer& operator=(HeatmapFrameBuffer& other) = delete;
+    HeatmapFrameBuffer& operator=(HeatmapFrameBuffer&& old) = delete;
+
+ protected:
+    void init_internal() override;
+    void bind_internal() override;
+    void cleanup_internal() override;
+};
+}  // namespace ui::widgets::opengl::fb
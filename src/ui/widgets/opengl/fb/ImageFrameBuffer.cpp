@@ -0,0 +1,15 @@
+#include "ImageFrameBuffer.hpp"
+#include "ui/widgets/opengl/fb/AbstractGlFrameBuffer.hpp"
+
+namespace ui::widgets::opengl::fb {
+
+// Matches the layout images get written in, so reading it back requires no conversion:
+ImageFrameBuffer::ImageFrameBuffer(GLsizei sizeX, GLsizei sizeY) : AbstractGlFrameBuffer(sizeX, sizeY, GL_RGBA8) {}
+
+void ImageFrameBuffer::init_internal() {}
+
+void ImageFrameBuffer::bind_internal() {}
+
+void ImageFrameBuffer::cleanup_internal() {}
+
+}  // namespace ui::widgets::opengl::fb
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "AbstractGlFrameBuffer.hpp"
+#include <epoxy/gl.h>
+#include <epoxy/gl_generated.h>
+
+namespace ui::widgets::opengl::fb {
+/**
+ * 8 bit RGBA frame buffer final frames get composed in before reading them back as image.
+ **/
+class ImageFrameBuffer : public AbstractGlFrameBuffer {
+ public:
+    ImageFrameBuffer(GLsizei sizeX, GLsizei sizeY);
+    ImageFrameBuffer(ImageFrameBuffer& other) = delete;
+    ImageFrameBuffer(ImageFrameBuffer&& old) = delete;
+
+    ~ImageFrameBuffer() override = default;
+
+    ImageFrameBuffer& operator=(ImageFrameBuffer& other) = delete;
+    ImageFrameBuffer& operator=(ImageFrameBuffer&& old) = delete;
+
+ protected:
+    void init_internal() override;
+    void bind_internal() override;
+    void cleanup_internal() override;
+};
+}  // namespace ui::widgets::opengl::fb
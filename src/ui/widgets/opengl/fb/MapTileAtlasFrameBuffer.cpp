@@ -0,0 +1,14 @@
+#include "MapTileAtlasFrameBuffer.hpp"
+#include "ui/widgets/opengl/fb/AbstractGlFrameBuffer.hpp"
+
+namespace ui::widgets::opengl::fb {
+
+MapTileAtlasFrameBuffer::MapTileAtlasFrameBuffer(GLsizei sizeX, GLsizei sizeY) : AbstractGlFrameBuffer(sizeX, sizeY) {}
+
+void MapTileAtlasFrameBuffer::init_internal() {}
+
+void MapTileAtlasFrameBuffer::bind_internal() {}
+
+void MapTileAtlasFrameBuffer::cleanup_internal() {}
+
+}  // namespace ui::widgets::opengl::fb
\ No newline at end of file
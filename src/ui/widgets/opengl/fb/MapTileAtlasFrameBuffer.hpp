@@ -0,0 +1,29 @@
+#pragma once
+
+#include "AbstractGlFrameBuffer.hpp"
+#include "MapTileAtlasFrameBuffer.hpp"
+#include <epoxy/gl.h>
+#include <epoxy/gl_generated.h>
+
+namespace ui::widgets::opengl::fb {
+/**
+ * Texture atlas all map tiles get rasterized to.
+ * Each tile occupies one tiles::TILE_SIZE x tiles::TILE_SIZE slot.
+ **/
+class MapTileAtlasFrameBuffer : public AbstractGlFrameBuffer {
+ public:
+    MapTileAtlasFrameBuffer(GLsizei sizeX, GLsizei sizeY);
+    MapTileAtlasFrameBuffer(MapTileAtlasFrameBuffer& other) = delete;
+    MapTileAtlasFrameBuffer(MapTileAtlasFrameBuffer&& old) = delete;
+
+    ~MapTileAtlasFrameBuffer() override = default;
+
+    MapTileAtlasFrameBuffer& operator=(MapTileAtlasFrameBuffer& other) = delete;
+    MapTileAtlasFrameBuffer& operator=(MapTileAtlasFrameBuffer&& old) = delete;
+
+ protected:
+    void init_internal() override;
+    void bind_internal() override;
+    void cleanup_internal() override;
+};
+}  // namespace ui::widgets::opengl::fb
\ No newline at end of file
@@ -0,0 +1,21 @@
+#include "TrailFrameBuffer.hpp"
+#include "ui/widgets/opengl/fb/AbstractGlFrameBuffer.hpp"
+#include "ui/widgets/opengl/utils/Utils.hpp"
+
+namespace ui::widgets::opengl::fb {
+
+TrailFrameBuffer::TrailFrameBuffer(GLsizei sizeX, GLsizei sizeY) : AbstractGlFrameBuffer(sizeX, sizeY) {}
+
+void TrailFrameBuffer::init_internal() {
+    // Interpolate when magnifying to screen size and repeat the edge instead of the border color while blurring:
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GLERR;
+}
+
+void TrailFrameBuffer::bind_internal() {}
+
+void TrailFrameBuffer::cleanup_internal() {}
+
+}  // namespace ui::widgets::opengl::fb
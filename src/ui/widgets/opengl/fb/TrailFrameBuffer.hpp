@@ -0,0 +1,28 @@
+#pragma once
+
+#include "AbstractGlFrameBuffer.hpp"
+#include <epoxy/gl.h>
+#include <epoxy/gl_generated.h>
+
+namespace ui::widgets::opengl::fb {
+/**
+ * Holds the downsampled entity trails.
+ * Gets magnified when drawn to screen and sampled at its edges while blurring.
+ **/
+class TrailFrameBuffer : public AbstractGlFrameBuffer {
+ public:
+    TrailFrameBuffer(GLsizei sizeX, GLsizei sizeY);
+    TrailFrameBuffer(TrailFrameBuffer& other) = delete;
+    TrailFrameBuffer(TrailFrameBuffer&& old) = delete;
+
+    ~TrailFrameBuffer() override = default;
+
+    TrailFrameBuffer& operator=(TrailFrameBuffer& other) = delete;
+    TrailFrameBuffer& operator=(TrailFrameBuffer&& old) = delete;
+
+ protected:
+    void init_internal() override;
+    void bind_internal() override;
+    void cleanup_internal() override;
+};
+}  // namespace ui::widgets::opengl::fb
@@ -0,0 +1,65 @@
+#include "Utils.hpp"
+#include <algorithm>
+#include <array>
+#include <unistd.h>
+
+namespace ui::widgets::opengl::utils {
+bool import_shared_buffer(const sim::gl_interop::SharedBufferHandle& handle, GLuint& memory, GLuint& buffer) {
+    if (!epoxy_has_gl_extension("GL_EXT_memory_object") || !epoxy_has_gl_extension("GL_EXT_memory_object_fd")) {
+        SPDLOG_INFO("Importing shared buffer not possible. GL_EXT_memory_object_fd is not supported.");
+        close(handle.fd);
+        return false;
+    }
+
+    // Memory can only be shared in case both APIs run on the same device and driver:
+    std::array<GLubyte, GL_UUID_SIZE_EXT> driverUuid{};
+    glGetUnsignedBytevEXT(GL_DRIVER_UUID_EXT, driverUuid.data());
+    GLint deviceCount = 0;
+    glGetIntegerv(GL_NUM_DEVICE_UUIDS_EXT, &deviceCount);
+    bool sameDevice = false;
+    for (GLuint i = 0; i < static_cast<GLuint>(deviceCount) && !sameDevice; i++) {
+        std::array<GLubyte, GL_UUID_SIZE_EXT> deviceUuid{};
+        glGetUnsignedBytei_vEXT(GL_DEVICE_UUID_EXT, i, deviceUuid.data());
+        sameDevice = std::equal(deviceUuid.begin(), deviceUuid.end(), handle.deviceUuid.begin());
+    }
+    if (!sameDevice || !std::equal(driverUuid.begin(), driverUuid.end(), handle.driverUuid.begin())) {
+        SPDLOG_INFO("Importing shared buffer not possible. OpenGL and Vulkan run on different devices or drivers.");
+        close(handle.fd);
+        return false;
+    }
+
+    // OpenGL takes ownership of the file descriptor:
+    glCreateMemoryObjectsEXT(1, &memory);
+    glImportMemoryFdEXT(memory, handle.memorySize, GL_HANDLE_TYPE_OPAQUE_FD_EXT, handle.fd);
+    glCreateBuffers(1, &buffer);
+    glNamedBufferStorageMemEXT(buffer, static_cast<GLsizeiptr>(handle.size), memory, 0);
+    if (glGetError() != GL_NO_ERROR) {
+        SPDLOG_WARN("Importing shared buffer failed.");
+        glDeleteBuffers(1, &buffer);
+        glDeleteMemoryObjectsEXT(1, &memory);
+        buffer = 0;
+        memory = 0;
+        return false;
+    }
+    return true;
+}
+
+bool import_shared_semaphore(int fd, GLuint& semaphore) {
+    if (!epoxy_has_gl_extension("GL_EXT_semaphore") || !epoxy_has_gl_extension("GL_EXT_semaphore_fd")) {
+        SPDLOG_INFO("Importing shared semaphore not possible. GL_EXT_semaphore_fd is not supported.");
+        close(fd);
+        return false;
+    }
+
+    // OpenGL takes ownership of the file descriptor:
+    glGenSemaphoresEXT(1, &semaphore);
+    glImportSemaphoreFdEXT(semaphore, GL_HANDLE_TYPE_OPAQUE_FD_EXT, fd);
+    if (glGetError() != GL_NO_ERROR) {
+        SPDLOG_WARN("Importing shared semaphore failed.");
+        glDeleteSemaphoresEXT(1, &semaphore);
+        semaphore = 0;
+        return false;
+    }
+    return true;
+}
+}  // namespace ui::widgets::opengl::utils
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "logger/Logger.hpp"
+#include "sim/GlInterop.hpp"
 #include <epoxy/gl.h>
 #include <epoxy/gl_generated.h>
 
@@ -14,4 +15,16 @@
     }
 
 namespace ui::widgets::opengl::utils {
-}  // namespace ui::widgets::opengl::utils
\ No newline at end of file
+/**
+ * Imports the given Vulkan buffer into the given memory object and buffer.
+ * Returns false in case the OpenGL implementation does not support importing it or runs on a different device or driver.
+ * Takes ownership of the file descriptor in either case.
+ **/
+bool import_shared_buffer(const sim::gl_interop::SharedBufferHandle& handle, GLuint& memory, GLuint& buffer);
+/**
+ * Imports the given Vulkan semaphore.
+ * Returns false in case the OpenGL implementation does not support importing it.
+ * Takes ownership of the file descriptor in either case.
+ **/
+bool import_shared_semaphore(int fd, GLuint& semaphore);
+}  // namespace ui::widgets::opengl::utils
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace utils {
+template <typename T>
+struct Snapshot {
+    T data{};
+    /**
+     * Set by the writer when publishing and strictly increasing, 0 for never published snapshots.
+     * Allows the reader to detect how many snapshots it skipped.
+     **/
+    uint64_t generation{0};
+};
+
+/**
+ * Lock free exchange of snapshots between a single writer and a single reader thread.
+ * The writer fills the back snapshot and publishes it, the reader acquires the newest published snapshot.
+ * Neither side ever waits for the other one or allocates, since both only swap indices into a fixed pool of three snapshots.
+ **/
+template <typename T>
+class TripleBuffer {
+ private:
+    /**
+     * Set on the middle index in case it holds a snapshot the reader did not acquire yet.
+     **/
+    static constexpr uint32_t UNREAD_BIT = 0b100;
+    static constexpr uint32_t INDEX_MASK = 0b011;
+
+    std::array<Snapshot<T>, 3> snapshots{};
+
+    /**
+     * Owned by the writer.
+     **/
+    uint32_t backIndex{0};
+    /**
+     * The only index shared between both threads.
+     * Holds the most recently published snapshot until the reader swaps it for its front snapshot.
+     **/
+    std::atomic<uint32_t> middleIndex{1};
+    /**
+     * Owned by the reader.
+     **/
+    uint32_t frontIndex{2};
+
+ public:
+    /**
+     * Initializes all three snapshots with the given value and drops all published ones.
+     * Not thread safe, so it has to be called before the writer and reader start.
+     **/
+    void reset(const T& value) {
+        for (Snapshot<T>& snapshot : snapshots) {
+            snapshot.data = value;
+            snapshot.generation = 0;
+        }
+        backIndex = 0;
+        middleIndex = 1;
+        frontIndex = 2;
+    }
+
+    // -----------------Writer-----------------
+    /**
+     * The snapshot the writer may fill. Stays the same until publish() gets called.
+     **/
+    T& get_back() {
+        return snapshots[backIndex].data;
+    }
+
+    /**
+     * Hands the back snapshot over to the reader and replaces any snapshot it did not acquire yet.
+     * The generation has to be larger than the one of the previously published snapshot.
+     **/
+    void publish(uint64_t generation) {
+        snapshots[backIndex].generation = generation;
+        // Release, so the reader sees the filled snapshot. Acquire, so we do not overwrite the one the reader just released:
+        backIndex = middleIndex.exchange(backIndex | UNREAD_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    /**
+     * Returns true in case the reader did not acquire the last published snapshot yet.
+     **/
+    [[nodiscard]] bool has_unread() const {
+        return (middleIndex.load(std::memory_order_relaxed) & UNREAD_BIT) != 0;
+    }
+
+    // -----------------Reader-----------------
+    /**
+     * Returns the newest published snapshot in case there is one the reader did not acquire yet, else nullptr.
+     * The snapshot stays valid until the next call.
+     **/
+    const Snapshot<T>* acquire() {
+        if (!has_unread()) {
+            return nullptr;
+        }
+        frontIndex = middleIndex.exchange(frontIndex, std::memory_order_acq_rel) & INDEX_MASK;
+        return &snapshots[frontIndex];
+    }
+};
+}  // namespace utils